@@ -0,0 +1,46 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+// Defines where a channel or list gets its memory from
+// alloc returns size bytes aligned for any standard type (or NULL on failure), and free gets back the pointer
+// together with the size it was allocated with, so a sized pool such as a C++ std::pmr::memory_resource can sit
+// behind it
+// alloc and free must either both be set or both be NULL; a NULL allocator, or one with both NULL, uses malloc
+// and free
+// alloc and free may be called from any thread that uses the channel, so a context shared between channels
+// that run concurrently must be thread-safe
+typedef struct {
+    void* (*alloc)(void* context, size_t size);
+    void (*free)(void* context, void* ptr, size_t size);
+    void* context;
+} allocator_t;
+
+// Allocates size bytes from the given allocator
+static inline void* allocator_alloc(const allocator_t* allocator, size_t size)
+{
+    assert(allocator == NULL || (allocator->alloc == NULL) == (allocator->free == NULL));
+    if (allocator == NULL || allocator->alloc == NULL) {
+        return malloc(size);
+    }
+    return allocator->alloc(allocator->context, size);
+}
+
+// Returns memory of the given size to the allocator it came from
+static inline void allocator_free(const allocator_t* allocator, void* ptr, size_t size)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    assert(allocator == NULL || (allocator->alloc == NULL) == (allocator->free == NULL));
+    if (allocator == NULL || allocator->alloc == NULL) {
+        free(ptr);
+        return;
+    }
+    allocator->free(allocator->context, ptr, size);
+}
+
+#endif // ALLOCATOR_H
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_util.h"
+#include "bench_throughput.h"
+#include "bench_latency.h"
+#include "bench_select.h"
+#include "bench_open_loop.h"
+#include "bench_scaling.h"
+#include "bench_baseline.h"
+#include "bench_memory.h"
+#include "bench_cpu.h"
+#include "bench_oversub.h"
+#include "bench_floyd.h"
+#include "bench_stress.h"
+#include "bench_send_recv.h"
+#include "bench_policy.h"
+
+bench_config_t bench_config = {
+    .warmup = 1,
+    .reps = 5,
+    .messages = 200000,
+    .quick = false,
+    .pipeline_depth = 3,
+    .format = BENCH_TEXT,
+    .out = NULL,
+};
+
+typedef void (*bench_fn_t)();
+typedef struct {
+    char* name;
+    bench_fn_t bench;
+} bench_t;
+
+bench_t benches[] = {{"throughput", bench_throughput},
+                      {"latency", bench_latency},
+                      {"select", bench_select},
+                      {"open_loop", bench_open_loop},
+                      {"scaling", bench_scaling},
+                      {"baseline", bench_baseline},
+                      {"memory", bench_memory},
+                      {"cpu", bench_cpu},
+                      {"oversub", bench_oversub},
+                      {"floyd", bench_floyd},
+                      {"stress", bench_stress},
+                      {"stress_capacity", bench_stress_capacity},
+                      {"send_recv", bench_send_recv},
+                      {"policy", bench_policy},
+};
+
+size_t num_benches = sizeof(benches)/sizeof(benches[0]);
+
+void usage(const char* prog) {
+    printf("Usage: %s [-q] [-w warmup] [-r reps] [-n messages] [-p depth] [-f text|csv|json] [-o file] [benchmark...]\n", prog);
+    printf("  -q          quick mode: shrink every sweep for a smoke run\n");
+    printf("  -w warmup   untimed repetitions per case (default %zu)\n", bench_config.warmup);
+    printf("  -r reps     timed repetitions per case (default %zu)\n", bench_config.reps);
+    printf("  -n messages messages per repetition (default %zu)\n", bench_config.messages);
+    printf("  -p depth    channels in the open_loop pipeline (default %zu)\n", bench_config.pipeline_depth);
+    printf("  -f format   result format: text, csv or json (default text)\n");
+    printf("  -o file     write results to file instead of stdout\n");
+    printf("Benchmarks:");
+    for (size_t i = 0; i < num_benches; i++) {
+        printf(" %s", benches[i].name);
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "qw:r:n:p:f:o:h")) != -1) {
+        switch (opt) {
+        case 'q':
+            bench_config.quick = true;
+            bench_config.warmup = 0;
+            bench_config.reps = 3;
+            bench_config.messages = 20000;
+            break;
+        case 'w':
+            bench_config.warmup = (size_t)atol(optarg);
+            break;
+        case 'r':
+            bench_config.reps = (size_t)atol(optarg);
+            break;
+        case 'n':
+            bench_config.messages = (size_t)atol(optarg);
+            break;
+        case 'p':
+            bench_config.pipeline_depth = (size_t)atol(optarg);
+            break;
+        case 'f':
+            if (strcmp(optarg, "csv") == 0) {
+                bench_config.format = BENCH_CSV;
+            } else if (strcmp(optarg, "json") == 0) {
+                bench_config.format = BENCH_JSON;
+            } else {
+                bench_config.format = BENCH_TEXT;
+            }
+            break;
+        case 'o':
+            bench_config.out = fopen(optarg, "w");
+            if (bench_config.out == NULL) {
+                printf("Could not open output file: %s\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return opt != 'h';
+        }
+    }
+    if (bench_config.reps == 0) {
+        bench_config.reps = 1;
+    }
+
+    for (int arg = optind; arg < argc; arg++) {
+        size_t i;
+        for (i = 0; i < num_benches; i++) {
+            if (strcmp(argv[arg], benches[i].name) == 0) {
+                break;
+            }
+        }
+        if (i == num_benches) {
+            printf("Did not find benchmark: %s\n", argv[arg]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind == argc) {
+        for (size_t i = 0; i < num_benches; i++) {
+            benches[i].bench();
+        }
+    }
+    for (int arg = optind; arg < argc; arg++) {
+        for (size_t i = 0; i < num_benches; i++) {
+            if (strcmp(argv[arg], benches[i].name) == 0) {
+                benches[i].bench();
+                break;
+            }
+        }
+    }
+    bench_report_finish();
+    if (bench_config.out != NULL) {
+        fclose(bench_config.out);
+    }
+    return 0;
+}
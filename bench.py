@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+
+import argparse
+import datetime
+import json
+import os
+import socket
+import subprocess
+import sys
+
+# Default gate configuration
+default_benches = ["throughput", "latency", "select", "baseline", "memory", "cpu", "send_recv"]
+default_tolerance = 0.10 # allowed relative throughput drop / cost increase
+default_latency_tolerance = 0.25 # allowed relative latency increase; tail percentiles are noisier
+results_dir = "bench_results"
+baselines_dir = "bench_baselines"
+timeout_make = 60
+timeout_bench = 1800
+
+# Metrics that are gated, keyed by unit: (metric names, True if higher is better, uses latency tolerance)
+gated_metrics = {
+    "msg/s": (["median", "achieved"], True, False),
+    "op/s": (["median", "round_trips"], True, False),
+    "hop/s": (["median"], True, False),
+    "ns": (["p50", "p99", "p999"], False, True),
+    "cpu ns/op": (["median"], False, False),
+    "wakeup/op": (["median"], False, False),
+    "per msg": (["cpu_ns", "voluntary"], False, False),
+    "B/channel": (["heap"], False, False),
+    "B/registration": (["heap"], False, False),
+}
+
+def git_revision():
+    try:
+        rev = subprocess.check_output(["git", "rev-parse", "--short", "HEAD"], stderr=subprocess.DEVNULL).decode().strip()
+        dirty = subprocess.call(["git", "diff", "--quiet", "HEAD", "--"], stderr=subprocess.DEVNULL) != 0
+        return rev + ("-dirty" if dirty else "")
+    except (subprocess.CalledProcessError, FileNotFoundError):
+        return "unknown"
+
+def build():
+    try:
+        subprocess.check_output(["make", "channel_bench"], stderr=subprocess.STDOUT, timeout=timeout_make)
+        return True
+    except subprocess.CalledProcessError as e:
+        print("****FAILED: make channel_bench****")
+        print(e.output.decode())
+    except subprocess.TimeoutExpired as e:
+        print(f"****FAILED: make channel_bench did not finish within {e.timeout} seconds****")
+    return False
+
+def run_benches(benches, bench_args):
+    output = os.path.join(results_dir, ".last_run.json")
+    args = ["./channel_bench", "-f", "json", "-o", output] + bench_args + benches
+    subprocess.check_call(args, timeout=timeout_bench)
+    with open(output) as fp:
+        return json.load(fp)
+
+def record_key(record, metric):
+    return "{}|{}|{}|{}".format(record["bench"], record["case"], record["unit"], metric)
+
+def flatten(records):
+    values = {}
+    for record in records:
+        if record["unit"] not in gated_metrics:
+            continue
+        metrics, higher_is_better, latency = gated_metrics[record["unit"]]
+        for metric in metrics:
+            if metric in record:
+                values[record_key(record, metric)] = (record[metric], higher_is_better, latency)
+    return values
+
+def compare(current, baseline, tolerance, latency_tolerance):
+    current_values = flatten(current["results"])
+    baseline_values = flatten(baseline["results"])
+    regressions = []
+    for key, (value, higher_is_better, latency) in sorted(current_values.items()):
+        if key not in baseline_values:
+            continue
+        base = baseline_values[key][0]
+        if base == 0:
+            continue
+        limit = latency_tolerance if latency else tolerance
+        change = (value - base) / base
+        worse = -change if higher_is_better else change
+        if worse > limit:
+            regressions.append((key, base, value, change))
+    return regressions
+
+def main():
+    parser = argparse.ArgumentParser(description="Run channel_bench, store JSON results and gate on a stored baseline")
+    parser.add_argument("benches", nargs="*", default=default_benches, help="benchmarks to run")
+    parser.add_argument("--baseline", help="baseline file (default: {}/<host>.json)".format(baselines_dir))
+    parser.add_argument("--update-baseline", action="store_true", help="store this run as the new baseline instead of comparing")
+    parser.add_argument("--tolerance", type=float, default=default_tolerance, help="allowed relative throughput/cost regression")
+    parser.add_argument("--latency-tolerance", type=float, default=default_latency_tolerance, help="allowed relative latency regression")
+    parser.add_argument("--quick", action="store_true", help="pass -q to channel_bench")
+    args = parser.parse_args()
+
+    if not build():
+        return 1
+    host = socket.gethostname()
+    revision = git_revision()
+    os.makedirs(os.path.join(results_dir, host), exist_ok=True)
+    bench_args = ["-q"] if args.quick else []
+    current = {
+        "revision": revision,
+        "host": host,
+        "date": datetime.datetime.now(datetime.timezone.utc).isoformat(),
+        "args": bench_args + args.benches,
+        "results": run_benches(args.benches, bench_args),
+    }
+    result_path = os.path.join(results_dir, host, "{}.json".format(revision))
+    with open(result_path, "w") as fp:
+        json.dump(current, fp, indent=2)
+    print(f"Results written to {result_path}")
+
+    baseline_path = args.baseline or os.path.join(baselines_dir, "{}.json".format(host))
+    if args.update_baseline:
+        os.makedirs(os.path.dirname(baseline_path) or ".", exist_ok=True)
+        with open(baseline_path, "w") as fp:
+            json.dump(current, fp, indent=2)
+        print(f"Baseline updated: {baseline_path}")
+        return 0
+    if not os.path.exists(baseline_path):
+        print(f"No baseline at {baseline_path}; run with --update-baseline to create one")
+        return 0
+    with open(baseline_path) as fp:
+        baseline = json.load(fp)
+    if baseline.get("args") != current["args"]:
+        print("Warning: baseline was recorded with different arguments: {}".format(" ".join(baseline.get("args", []))))
+
+    regressions = compare(current, baseline, args.tolerance, args.latency_tolerance)
+    print("Compared against baseline {} ({})".format(baseline.get("revision"), baseline_path))
+    for key, base, value, change in regressions:
+        print(f"****REGRESSION: {key}: {base:.6g} -> {value:.6g} ({change:+.1%})****")
+    if regressions:
+        print(f"{len(regressions)} metric(s) regressed beyond tolerance")
+        return 1
+    print("No regressions beyond tolerance")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,345 @@
+#include <pthread.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include "channel.h"
+#include "bench_util.h"
+#include "bench_baseline.h"
+
+#define BASELINE_CAPACITY 64
+
+// Defines one way of moving pointer-sized messages from a single producer to a single consumer
+typedef struct {
+    const char* name;
+    void* (*create)(size_t capacity);
+    void (*send)(void* transport, uintptr_t value);
+    uintptr_t (*receive)(void* transport);
+    void (*destroy)(void* transport);
+} transport_t;
+
+// Writes exactly size bytes, retrying short writes
+static void write_all(int fd, const void* buf, size_t size)
+{
+    const char* p = buf;
+    while (size > 0) {
+        ssize_t written = write(fd, p, size);
+        assert(written > 0);
+        p += written;
+        size -= (size_t)written;
+    }
+}
+
+// Reads exactly size bytes, retrying short reads
+static void read_all(int fd, void* buf, size_t size)
+{
+    char* p = buf;
+    while (size > 0) {
+        ssize_t got = read(fd, p, size);
+        assert(got > 0);
+        p += got;
+        size -= (size_t)got;
+    }
+}
+
+static void* channel_transport_create(size_t capacity)
+{
+    return channel_create(capacity);
+}
+
+static void channel_transport_send(void* transport, uintptr_t value)
+{
+    enum channel_status status = channel_send(transport, (void*)value);
+    assert(status == SUCCESS);
+}
+
+static uintptr_t channel_transport_receive(void* transport)
+{
+    void* data = NULL;
+    enum channel_status status = channel_receive(transport, &data);
+    assert(status == SUCCESS);
+    return (uintptr_t)data;
+}
+
+static void channel_transport_destroy(void* transport)
+{
+    channel_close(transport);
+    channel_destroy(transport);
+}
+
+// Holds both ends of a pipe or socketpair; fd[1] is written and fd[0] is read
+typedef struct {
+    int fd[2];
+} fd_pair_t;
+
+static void* pipe_create(size_t capacity)
+{
+    (void)capacity;
+    fd_pair_t* pair = malloc(sizeof(fd_pair_t));
+    assert(pair != NULL);
+    int status = pipe(pair->fd);
+    assert(status == 0);
+    return pair;
+}
+
+static void* socketpair_create(size_t capacity)
+{
+    (void)capacity;
+    fd_pair_t* pair = malloc(sizeof(fd_pair_t));
+    assert(pair != NULL);
+    int status = socketpair(AF_UNIX, SOCK_STREAM, 0, pair->fd);
+    assert(status == 0);
+    return pair;
+}
+
+static void fd_pair_send(void* transport, uintptr_t value)
+{
+    write_all(((fd_pair_t*)transport)->fd[1], &value, sizeof(value));
+}
+
+static uintptr_t fd_pair_receive(void* transport)
+{
+    uintptr_t value;
+    read_all(((fd_pair_t*)transport)->fd[0], &value, sizeof(value));
+    return value;
+}
+
+static void fd_pair_destroy(void* transport)
+{
+    fd_pair_t* pair = transport;
+    close(pair->fd[0]);
+    close(pair->fd[1]);
+    free(pair);
+}
+
+// A single-producer single-consumer ring whose free slots and filled items are counted by two semaphore eventfds
+typedef struct {
+    int items;
+    int slots;
+    size_t capacity;
+    size_t head;
+    size_t tail;
+    uintptr_t* data;
+} eventfd_ring_t;
+
+static void* eventfd_ring_create(size_t capacity)
+{
+    eventfd_ring_t* ring = malloc(sizeof(eventfd_ring_t));
+    assert(ring != NULL);
+    ring->items = eventfd(0, EFD_SEMAPHORE);
+    ring->slots = eventfd((unsigned)capacity, EFD_SEMAPHORE);
+    assert(ring->items >= 0 && ring->slots >= 0);
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->data = malloc(sizeof(uintptr_t) * capacity);
+    assert(ring->data != NULL);
+    return ring;
+}
+
+static void eventfd_ring_send(void* transport, uintptr_t value)
+{
+    eventfd_ring_t* ring = transport;
+    uint64_t count;
+    read_all(ring->slots, &count, sizeof(count));
+    ring->data[ring->tail] = value;
+    ring->tail = ring->tail + 1 == ring->capacity ? 0 : ring->tail + 1;
+    count = 1;
+    // the eventfd write is a full barrier, publishing the slot before the consumer can see the item
+    write_all(ring->items, &count, sizeof(count));
+}
+
+static uintptr_t eventfd_ring_receive(void* transport)
+{
+    eventfd_ring_t* ring = transport;
+    uint64_t count;
+    read_all(ring->items, &count, sizeof(count));
+    uintptr_t value = ring->data[ring->head];
+    ring->head = ring->head + 1 == ring->capacity ? 0 : ring->head + 1;
+    count = 1;
+    write_all(ring->slots, &count, sizeof(count));
+    return value;
+}
+
+static void eventfd_ring_destroy(void* transport)
+{
+    eventfd_ring_t* ring = transport;
+    close(ring->items);
+    close(ring->slots);
+    free(ring->data);
+    free(ring);
+}
+
+// The textbook bounded queue: one mutex and a condition variable per direction
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    size_t capacity;
+    size_t head;
+    size_t size;
+    uintptr_t* data;
+} mutex_queue_t;
+
+static void* mutex_queue_create(size_t capacity)
+{
+    mutex_queue_t* queue = malloc(sizeof(mutex_queue_t));
+    assert(queue != NULL);
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    queue->capacity = capacity;
+    queue->head = 0;
+    queue->size = 0;
+    queue->data = malloc(sizeof(uintptr_t) * capacity);
+    assert(queue->data != NULL);
+    return queue;
+}
+
+static void mutex_queue_send(void* transport, uintptr_t value)
+{
+    mutex_queue_t* queue = transport;
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->size == queue->capacity) {
+        pthread_cond_wait(&queue->not_full, &queue->mutex);
+    }
+    queue->data[(queue->head + queue->size) % queue->capacity] = value;
+    queue->size++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+static uintptr_t mutex_queue_receive(void* transport)
+{
+    mutex_queue_t* queue = transport;
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->size == 0) {
+        pthread_cond_wait(&queue->not_empty, &queue->mutex);
+    }
+    uintptr_t value = queue->data[queue->head];
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->size--;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->mutex);
+    return value;
+}
+
+static void mutex_queue_destroy(void* transport)
+{
+    mutex_queue_t* queue = transport;
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+    free(queue->data);
+    free(queue);
+}
+
+static const transport_t transports[] = {
+    {"channel", channel_transport_create, channel_transport_send, channel_transport_receive, channel_transport_destroy},
+    {"mutex_queue", mutex_queue_create, mutex_queue_send, mutex_queue_receive, mutex_queue_destroy},
+    {"eventfd_ring", eventfd_ring_create, eventfd_ring_send, eventfd_ring_receive, eventfd_ring_destroy},
+    {"pipe", pipe_create, fd_pair_send, fd_pair_receive, fd_pair_destroy},
+    {"socketpair", socketpair_create, fd_pair_send, fd_pair_receive, fd_pair_destroy},
+};
+
+typedef struct {
+    const transport_t* transport;
+    void* in;
+    void* out;
+    size_t count;
+} peer_args_t;
+
+// Receives count messages; when out is set, echoes each one back for ping-pong
+static void* peer(void* arg)
+{
+    peer_args_t* args = arg;
+    for (size_t i = 1; i <= args->count; i++) {
+        uintptr_t value = args->transport->receive(args->in);
+        assert(value == i);
+        if (args->out != NULL) {
+            args->transport->send(args->out, value);
+        }
+    }
+    return NULL;
+}
+
+// Streams count messages to a consumer thread and returns messages/sec
+static double run_throughput(const transport_t* transport, size_t count)
+{
+    void* stream = transport->create(BASELINE_CAPACITY);
+    peer_args_t args = {transport, stream, NULL, count};
+    pthread_t pid;
+    uint64_t t = bench_now_ns();
+    int pthread_status = pthread_create(&pid, NULL, peer, &args);
+    assert(pthread_status == 0);
+    for (size_t i = 1; i <= count; i++) {
+        transport->send(stream, i);
+    }
+    pthread_join(pid, NULL);
+    t = bench_now_ns() - t;
+    transport->destroy(stream);
+    return (double)count * 1e9 / (double)t;
+}
+
+// Bounces count messages off an echo thread, recording every round trip
+static void run_latency(const transport_t* transport, size_t count, bench_hist_t* hist)
+{
+    void* ping = transport->create(BASELINE_CAPACITY);
+    void* pong = transport->create(BASELINE_CAPACITY);
+    peer_args_t args = {transport, ping, pong, count};
+    pthread_t pid;
+    int pthread_status = pthread_create(&pid, NULL, peer, &args);
+    assert(pthread_status == 0);
+    for (size_t i = 1; i <= count; i++) {
+        uint64_t t = bench_ticks();
+        transport->send(ping, i);
+        uintptr_t value = transport->receive(pong);
+        t = bench_ticks() - t;
+        assert(value == i);
+        bench_hist_record(hist, bench_ticks_to_ns(t));
+    }
+    pthread_join(pid, NULL);
+    transport->destroy(ping);
+    transport->destroy(pong);
+}
+
+// Moves the same message stream through channel_t, a pipe, a socketpair, an eventfd-signalled ring
+// and a mutex+condvar queue, and reports throughput and ping-pong latency for each
+void bench_baseline()
+{
+    size_t num_transports = sizeof(transports) / sizeof(transports[0]);
+    double* samples = malloc(sizeof(double) * bench_config.reps);
+    bench_hist_t* hist = malloc(sizeof(bench_hist_t));
+    assert(samples != NULL && hist != NULL);
+
+    bench_report_header("baseline throughput");
+    for (size_t i = 0; i < num_transports; i++) {
+        for (size_t w = 0; w < bench_config.warmup; w++) {
+            run_throughput(&transports[i], bench_config.messages);
+        }
+        for (size_t r = 0; r < bench_config.reps; r++) {
+            samples[r] = run_throughput(&transports[i], bench_config.messages);
+        }
+        bench_stats_t stats;
+        bench_stats_compute(samples, bench_config.reps, &stats);
+        bench_report("baseline", transports[i].name, "msg/s", &stats);
+    }
+
+    bench_report_latency_header("baseline latency");
+    // round trips are far slower than streaming, so run a tenth as many
+    size_t rounds = bench_config.messages / 10 > 0 ? bench_config.messages / 10 : 1;
+    for (size_t i = 0; i < num_transports; i++) {
+        bench_hist_reset(hist);
+        for (size_t r = 0; r < bench_config.reps; r++) {
+            run_latency(&transports[i], rounds, hist);
+        }
+        char case_name[128];
+        snprintf(case_name, sizeof(case_name), "%s pingpong", transports[i].name);
+        bench_report_latency("baseline", case_name, hist);
+    }
+    free(hist);
+    free(samples);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_BASELINE_H
+#define BENCH_BASELINE_H
+
+// Moves the same message stream through channel_t, a pipe, a socketpair, an eventfd-signalled ring
+// and a mutex+condvar queue, and reports throughput and ping-pong latency for each
+void bench_baseline();
+
+#endif // BENCH_BASELINE_H
@@ -0,0 +1,239 @@
+#include <pthread.h>
+#include <sched.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "channel.h"
+#include "bench_util.h"
+#include "bench_cpu.h"
+
+// Number of cases each selector waits on in the select workload
+#define SELECT_CASES 8
+
+enum role {
+    PRODUCER,
+    CONSUMER
+};
+
+enum op {
+    BLOCKING,
+    NON_BLOCKING,
+    SELECT
+};
+
+typedef struct {
+    channel_t** channels;
+    size_t num_channels;
+    size_t count;
+    enum role role;
+    enum op op;
+    pthread_barrier_t* start;
+    bench_usage_t usage;
+} cpu_args_t;
+
+static void produce(cpu_args_t* args)
+{
+    for (size_t i = 1; i <= args->count; i++) {
+        channel_t* channel = args->channels[i % args->num_channels];
+        enum channel_status status;
+        if (args->op == NON_BLOCKING) {
+            while ((status = channel_non_blocking_send(channel, (void*)i)) == CHANNEL_FULL) {
+                sched_yield();
+            }
+        } else {
+            status = channel_send(channel, (void*)i);
+        }
+        assert(status == SUCCESS);
+    }
+}
+
+static void consume(cpu_args_t* args)
+{
+    select_t select_list[SELECT_CASES];
+    for (size_t i = 0; i < args->num_channels && i < SELECT_CASES; i++) {
+        select_list[i].channel = args->channels[i];
+        select_list[i].dir = RECV;
+        select_list[i].data = NULL;
+    }
+    for (size_t i = 0; i < args->count; i++) {
+        void* data = NULL;
+        enum channel_status status;
+        if (args->op == SELECT) {
+            size_t selected_index;
+            status = channel_select(select_list, args->num_channels, &selected_index);
+        } else if (args->op == NON_BLOCKING) {
+            while ((status = channel_non_blocking_receive(args->channels[0], &data)) == CHANNEL_EMPTY) {
+                sched_yield();
+            }
+        } else {
+            status = channel_receive(args->channels[0], &data);
+        }
+        assert(status == SUCCESS);
+    }
+}
+
+// Runs one side of the workload and records this thread's own CPU time and context switches
+static void* participant(void* arg)
+{
+    cpu_args_t* args = arg;
+    bench_usage_t start;
+    bench_usage_t end;
+    pthread_barrier_wait(args->start);
+    bench_usage_thread(&start);
+    if (args->role == PRODUCER) {
+        produce(args);
+    } else {
+        consume(args);
+    }
+    bench_usage_thread(&end);
+    args->usage.cpu_ns = end.cpu_ns - start.cpu_ns;
+    args->usage.voluntary = end.voluntary - start.voluntary;
+    args->usage.involuntary = end.involuntary - start.involuntary;
+    return NULL;
+}
+
+static void report_usage(const char* case_name, const bench_usage_t* usage, size_t messages)
+{
+    static const char* const names[] = {"cpu_ns", "voluntary", "involuntary"};
+    double values[] = {(double)usage->cpu_ns / (double)messages, (double)usage->voluntary / (double)messages, (double)usage->involuntary / (double)messages};
+    bench_report_values("cpu", case_name, "per msg", names, values, 3);
+    if (bench_config.format == BENCH_TEXT) {
+        fprintf(bench_report_file(), "%-40s %14.1f %14.4f %14.4f\n", case_name, values[0], values[1], values[2]);
+    }
+}
+
+// Moves messages from num_producers to num_consumers and reports per-role and total cost per message
+static void run_workload(const char* name, size_t capacity, size_t num_producers, size_t num_consumers, enum op op)
+{
+    size_t num_channels = op == SELECT ? SELECT_CASES : 1;
+    size_t unit = num_producers * num_consumers;
+    size_t total = (bench_config.messages / unit) * unit;
+    channel_t* channels[SELECT_CASES];
+    for (size_t i = 0; i < num_channels; i++) {
+        channels[i] = channel_create(capacity);
+        assert(channels[i] != NULL);
+    }
+    size_t num_threads = num_producers + num_consumers;
+    pthread_t* pid = malloc(sizeof(pthread_t) * num_threads);
+    cpu_args_t* args = malloc(sizeof(cpu_args_t) * num_threads);
+    assert(pid != NULL && args != NULL);
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, (unsigned)num_threads);
+    for (size_t i = 0; i < num_threads; i++) {
+        args[i].channels = channels;
+        args[i].num_channels = num_channels;
+        args[i].role = i < num_producers ? PRODUCER : CONSUMER;
+        args[i].count = args[i].role == PRODUCER ? total / num_producers : total / num_consumers;
+        args[i].op = op;
+        args[i].start = &start;
+        int pthread_status = pthread_create(&pid[i], NULL, participant, &args[i]);
+        assert(pthread_status == 0);
+    }
+    bench_usage_t roles[2] = {{0, 0, 0}, {0, 0, 0}};
+    for (size_t i = 0; i < num_threads; i++) {
+        pthread_join(pid[i], NULL);
+        roles[args[i].role].cpu_ns += args[i].usage.cpu_ns;
+        roles[args[i].role].voluntary += args[i].usage.voluntary;
+        roles[args[i].role].involuntary += args[i].usage.involuntary;
+    }
+    pthread_barrier_destroy(&start);
+    for (size_t i = 0; i < num_channels; i++) {
+        channel_close(channels[i]);
+        channel_destroy(channels[i]);
+    }
+    free(args);
+    free(pid);
+
+    bench_usage_t sum = {roles[PRODUCER].cpu_ns + roles[CONSUMER].cpu_ns,
+                         roles[PRODUCER].voluntary + roles[CONSUMER].voluntary,
+                         roles[PRODUCER].involuntary + roles[CONSUMER].involuntary};
+    char case_name[128];
+    snprintf(case_name, sizeof(case_name), "%s producers", name);
+    report_usage(case_name, &roles[PRODUCER], total);
+    snprintf(case_name, sizeof(case_name), "%s consumers", name);
+    report_usage(case_name, &roles[CONSUMER], total);
+    snprintf(case_name, sizeof(case_name), "%s total", name);
+    report_usage(case_name, &sum, total);
+}
+
+typedef struct {
+    channel_t* channel;
+    enum direction dir;
+    bool select;
+    bench_usage_t usage;
+} idle_args_t;
+
+// Blocks in send, receive or select until the channel is closed and records the CPU spent while blocked
+static void* idle_waiter(void* arg)
+{
+    idle_args_t* args = arg;
+    bench_usage_t start;
+    bench_usage_t end;
+    bench_usage_thread(&start);
+    enum channel_status status;
+    if (args->select) {
+        select_t select_list[1] = {{args->channel, args->dir, NULL}};
+        size_t selected_index;
+        status = channel_select(select_list, 1, &selected_index);
+    } else if (args->dir == SEND) {
+        status = channel_send(args->channel, (void*)1);
+    } else {
+        void* data = NULL;
+        status = channel_receive(args->channel, &data);
+    }
+    assert(status == CLOSED_ERROR);
+    bench_usage_thread(&end);
+    args->usage.cpu_ns = end.cpu_ns - start.cpu_ns;
+    args->usage.voluntary = end.voluntary - start.voluntary;
+    args->usage.involuntary = end.involuntary - start.involuntary;
+    return NULL;
+}
+
+// Keeps one thread blocked for the given time and reports what it consumed
+static void run_idle(const char* name, enum direction dir, bool select, useconds_t duration_usec)
+{
+    channel_t* channel = channel_create(1);
+    assert(channel != NULL);
+    if (dir == SEND) {
+        // fill the channel so the sender has to block
+        enum channel_status status = channel_send(channel, (void*)1);
+        assert(status == SUCCESS);
+    }
+    idle_args_t args = {channel, dir, select, {0, 0, 0}};
+    pthread_t pid;
+    int pthread_status = pthread_create(&pid, NULL, idle_waiter, &args);
+    assert(pthread_status == 0);
+    usleep(duration_usec);
+    channel_close(channel);
+    pthread_join(pid, NULL);
+    channel_destroy(channel);
+
+    static const char* const names[] = {"cpu_ns", "voluntary", "involuntary"};
+    double values[] = {(double)args.usage.cpu_ns, (double)args.usage.voluntary, (double)args.usage.involuntary};
+    char case_name[128];
+    snprintf(case_name, sizeof(case_name), "idle %s %ums", name, duration_usec / 1000);
+    bench_report_values("cpu", case_name, "per wait", names, values, 3);
+    if (bench_config.format == BENCH_TEXT) {
+        fprintf(bench_report_file(), "%-40s %14.1f %14.4f %14.4f\n", case_name, values[0], values[1], values[2]);
+    }
+}
+
+// Reports per-thread CPU nanoseconds and voluntary/involuntary context switches per message for each workload,
+// and the CPU burned by threads blocked in send, receive and select
+void bench_cpu()
+{
+    if (bench_config.format == BENCH_TEXT) {
+        fprintf(bench_report_file(), "\n== cpu ==\n%-40s %14s %14s %14s\n", "case (per message, or per blocked wait)", "cpu ns", "voluntary cs", "involuntary cs");
+    }
+    run_workload("spsc blk cap=1", 1, 1, 1, BLOCKING);
+    run_workload("spsc blk cap=64", 64, 1, 1, BLOCKING);
+    run_workload("spsc nb cap=64", 64, 1, 1, NON_BLOCKING);
+    run_workload("mpmc blk 4x4 cap=64", 64, 4, 4, BLOCKING);
+    run_workload("select recv 8 cases cap=64", 64, 1, 1, SELECT);
+    useconds_t window = bench_config.quick ? 20000 : 200000;
+    run_idle("receive", RECV, false, window);
+    run_idle("send", SEND, false, window);
+    run_idle("select receive", RECV, true, window);
+    run_idle("select send", SEND, true, window);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_CPU_H
+#define BENCH_CPU_H
+
+// Reports per-thread CPU nanoseconds and voluntary/involuntary context switches per message for each workload,
+// and the CPU burned by threads blocked in send, receive and select
+void bench_cpu();
+
+#endif // BENCH_CPU_H
@@ -0,0 +1,92 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_util.h"
+#include "floyd_warshall.h"
+#include "bench_floyd.h"
+
+// Average out-degree of the random topologies, close to that of the bundled topology files
+#define FLOYD_DEGREE 8
+// Largest topology the textbook triple loop is still timed on
+#define FLOYD_REFERENCE_MAX 1024
+
+// Fills a count x count link matrix with roughly FLOYD_DEGREE random links per node, weights 1 to 100
+static void random_topology(distance_t* topology, size_t count, unsigned int seed)
+{
+    srand(seed);
+    for (size_t src = 0; src < count; src++) {
+        for (size_t dst = 0; dst < count; dst++) {
+            topology[src * count + dst] = src == dst ? 0 : inf_distance;
+        }
+        for (size_t link = 0; link < FLOYD_DEGREE; link++) {
+            size_t dst = (size_t)rand() % count;
+            if (dst != src) {
+                topology[src * count + dst] = (distance_t)(rand() % 100 + 1);
+            }
+        }
+    }
+}
+
+// Solves a fresh copy of the topology and returns the elapsed milliseconds
+// num_threads of SIZE_MAX selects the reference triple loop
+static double run_solve(const distance_t* topology, distance_t* solution, size_t count, size_t num_threads)
+{
+    memcpy(solution, topology, sizeof(distance_t) * count * count);
+    uint64_t t = bench_now_ns();
+    if (num_threads == SIZE_MAX) {
+        floyd_warshall_reference(solution, count);
+    } else {
+        floyd_warshall(solution, count, num_threads);
+    }
+    return (double)(bench_now_ns() - t) / 1e6;
+}
+
+// Times the all-pairs shortest path solve used to validate run_stress on random topologies of growing size:
+// the textbook triple loop, the blocked kernel on one thread, and the blocked kernel on every CPU
+void bench_floyd()
+{
+    size_t sizes[] = {128, 256, 512, 1024, 2048};
+    size_t num_sizes = bench_config.quick ? 2 : sizeof(sizes) / sizeof(sizes[0]);
+    double* samples = malloc(sizeof(double) * bench_config.reps);
+    assert(samples != NULL);
+
+    bench_report_header("floyd");
+    for (size_t s = 0; s < num_sizes; s++) {
+        size_t count = sizes[s];
+        distance_t* topology = malloc(sizeof(distance_t) * count * count);
+        distance_t* solution = malloc(sizeof(distance_t) * count * count);
+        distance_t* expected = malloc(sizeof(distance_t) * count * count);
+        assert(topology != NULL && solution != NULL && expected != NULL);
+        random_topology(topology, count, (unsigned int)count);
+        bool has_reference = count <= FLOYD_REFERENCE_MAX;
+        if (has_reference) {
+            run_solve(topology, expected, count, SIZE_MAX);
+        }
+
+        struct {
+            const char* name;
+            size_t num_threads;
+        } variants[] = {{"reference", SIZE_MAX}, {"blocked 1 thread", 1}, {"blocked all cpus", 0}};
+        for (size_t v = has_reference ? 0 : 1; v < sizeof(variants) / sizeof(variants[0]); v++) {
+            for (size_t w = 0; w < bench_config.warmup; w++) {
+                run_solve(topology, solution, count, variants[v].num_threads);
+            }
+            for (size_t r = 0; r < bench_config.reps; r++) {
+                samples[r] = run_solve(topology, solution, count, variants[v].num_threads);
+            }
+            if (has_reference) {
+                assert(memcmp(solution, expected, sizeof(distance_t) * count * count) == 0);
+            }
+            bench_stats_t stats;
+            bench_stats_compute(samples, bench_config.reps, &stats);
+            char case_name[128];
+            snprintf(case_name, sizeof(case_name), "n=%zu %s", count, variants[v].name);
+            bench_report("floyd", case_name, "ms", &stats);
+        }
+        free(topology);
+        free(solution);
+        free(expected);
+    }
+    free(samples);
+}
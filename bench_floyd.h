@@ -0,0 +1,8 @@
+#ifndef BENCH_FLOYD_H
+#define BENCH_FLOYD_H
+
+// Times the all-pairs shortest path solve used to validate run_stress on random topologies of growing size:
+// the textbook triple loop, the blocked kernel on one thread, and the blocked kernel on every CPU
+void bench_floyd();
+
+#endif // BENCH_FLOYD_H
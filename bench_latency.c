@@ -0,0 +1,102 @@
+#include <pthread.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "channel.h"
+#include "bench_util.h"
+#include "bench_latency.h"
+
+typedef struct {
+    channel_t* ping;
+    channel_t* pong;
+    size_t rounds;
+    size_t cpu;
+} pong_args_t;
+
+// Echoes every message from ping back on pong until it receives NULL
+static void* pong_thread(void* arg)
+{
+    pong_args_t* args = arg;
+    bench_pin_self(args->cpu);
+    while (true) {
+        void* data = NULL;
+        enum channel_status status = channel_receive(args->ping, &data);
+        assert(status == SUCCESS);
+        if (data == NULL) {
+            break;
+        }
+        status = channel_send(args->pong, data);
+        assert(status == SUCCESS);
+    }
+    return NULL;
+}
+
+// Bounces rounds messages off the pong thread, recording each round trip
+static void ping(channel_t* ping, channel_t* pong, size_t rounds, bench_hist_t* hist)
+{
+    for (size_t i = 1; i <= rounds; i++) {
+        void* data = NULL;
+        uint64_t t = bench_ticks();
+        enum channel_status status = channel_send(ping, (void*)i);
+        assert(status == SUCCESS);
+        status = channel_receive(pong, &data);
+        assert(status == SUCCESS);
+        t = bench_ticks() - t;
+        assert((size_t)data == i);
+        if (hist != NULL) {
+            bench_hist_record(hist, bench_ticks_to_ns(t));
+        }
+    }
+}
+
+static void run_case(size_t capacity, size_t ping_cpu, size_t pong_cpu, const char* placement)
+{
+    channel_t* ping_channel = channel_create(capacity);
+    channel_t* pong_channel = channel_create(capacity);
+    assert(ping_channel != NULL && pong_channel != NULL);
+    pong_args_t args = {ping_channel, pong_channel, bench_config.messages, pong_cpu};
+    pthread_t pid;
+    int pthread_status = pthread_create(&pid, NULL, pong_thread, &args);
+    assert(pthread_status == 0);
+    bench_pin_self(ping_cpu);
+
+    bench_hist_t* hist = malloc(sizeof(bench_hist_t));
+    assert(hist != NULL);
+    bench_hist_reset(hist);
+    ping(ping_channel, pong_channel, bench_config.warmup * bench_config.messages / 10, NULL);
+    for (size_t i = 0; i < bench_config.reps; i++) {
+        ping(ping_channel, pong_channel, bench_config.messages, hist);
+    }
+
+    enum channel_status status = channel_send(ping_channel, NULL);
+    assert(status == SUCCESS);
+    pthread_join(pid, NULL);
+    channel_close(ping_channel);
+    channel_destroy(ping_channel);
+    channel_close(pong_channel);
+    channel_destroy(pong_channel);
+
+    char case_name[128];
+    snprintf(case_name, sizeof(case_name), "pingpong %s cap=%zu", placement, capacity);
+    bench_report_latency("latency", case_name, hist);
+    free(hist);
+}
+
+// Measures ping-pong round-trip latency between two pinned threads over a pair of channels,
+// with the threads on separate cores and sharing one core
+void bench_latency()
+{
+    // capacity 0 is left out: channel.c has no rendezvous path, so an unbuffered send only returns on close
+    static const size_t capacities[] = {1, 64};
+
+    bench_report_latency_header("latency");
+    for (size_t c = 0; c < sizeof(capacities) / sizeof(size_t); c++) {
+        if (bench_num_cpus() > 1) {
+            run_case(capacities[c], 0, 1, "cross-core");
+        } else {
+            fprintf(stderr, "pingpong cross-core cap=%zu skipped: only one CPU online\n", capacities[c]);
+        }
+        run_case(capacities[c], 0, 0, "same-core");
+    }
+    bench_unpin_self();
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_LATENCY_H
+#define BENCH_LATENCY_H
+
+// Measures ping-pong round-trip latency between two pinned threads over a pair of channels,
+// with the threads on separate cores and sharing one core
+void bench_latency();
+
+#endif // BENCH_LATENCY_H
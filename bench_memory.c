@@ -0,0 +1,292 @@
+#include <pthread.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <malloc.h>
+#include "channel.h"
+#include "bench_util.h"
+#include "bench_memory.h"
+
+// Stack size of parked threads; small so that stacks do not drown out the channel's own footprint
+#define PARKED_STACK_SIZE (64 * 1024)
+
+typedef struct {
+    // Resident set size in bytes
+    size_t rss;
+    // Heap bytes handed out by malloc and not yet freed
+    size_t heap;
+    // Heap bytes obtained from the system, in use or not
+    size_t arena;
+} memory_t;
+
+static void memory_sample(memory_t* memory)
+{
+    size_t pages = 0;
+    size_t resident = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file != NULL) {
+        if (fscanf(file, "%zu %zu", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(file);
+    }
+    memory->rss = resident * (size_t)sysconf(_SC_PAGESIZE);
+    struct mallinfo2 info = mallinfo2();
+    memory->heap = info.uordblks + info.hblkhd;
+    memory->arena = info.arena + info.hblkhd;
+}
+
+static double per_item(size_t after, size_t before, size_t items)
+{
+    return ((double)after - (double)before) / (double)items;
+}
+
+static void report_row(const char* case_name, const char* unit, double rss, double heap)
+{
+    static const char* const names[] = {"rss", "heap"};
+    double values[] = {rss, heap};
+    bench_report_values("memory", case_name, unit, names, values, 2);
+    if (bench_config.format == BENCH_TEXT) {
+        fprintf(bench_report_file(), "%-40s %-14s %12.1f %12.1f\n", case_name, unit, rss, heap);
+    }
+}
+
+// Creates count channels of the given capacity and reports the footprint of each
+static void channel_footprint(size_t count, size_t capacity)
+{
+    channel_t** channels = malloc(sizeof(channel_t*) * count);
+    assert(channels != NULL);
+    memory_t before;
+    memory_t after;
+    malloc_trim(0);
+    memory_sample(&before);
+    for (size_t i = 0; i < count; i++) {
+        channels[i] = channel_create(capacity);
+        assert(channels[i] != NULL);
+    }
+    memory_sample(&after);
+
+    char case_name[128];
+    snprintf(case_name, sizeof(case_name), "channel n=%zu cap=%zu", count, capacity);
+    report_row(case_name, "B/channel", per_item(after.rss, before.rss, count), per_item(after.heap, before.heap, count));
+
+    for (size_t i = 0; i < count; i++) {
+        channel_close(channels[i]);
+        channel_destroy(channels[i]);
+    }
+    free(channels);
+}
+
+typedef struct {
+    select_t* select_list;
+    size_t select_count;
+    channel_t* channel;
+    sem_t* started;
+} parked_args_t;
+
+static void* parked_receive(void* arg)
+{
+    parked_args_t* args = arg;
+    void* data = NULL;
+    sem_post(args->started);
+    enum channel_status status = channel_receive(args->channel, &data);
+    assert(status == CLOSED_ERROR);
+    return NULL;
+}
+
+static void* parked_select(void* arg)
+{
+    parked_args_t* args = arg;
+    size_t selected_index;
+    sem_post(args->started);
+    enum channel_status status = channel_select(args->select_list, args->select_count, &selected_index);
+    assert(status == CLOSED_ERROR);
+    return NULL;
+}
+
+// Returns the number of select registrations currently held across the given channels
+static size_t registrations(channel_t** channels, size_t count)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        pthread_mutex_lock(&channels[i]->mutex);
+        total += list_count(channels[i]->select);
+        pthread_mutex_unlock(&channels[i]->mutex);
+    }
+    return total;
+}
+
+// Parks num_threads threads, in channel_receive when cases is 0 and in channel_select over cases channels otherwise
+// Fills memory with the footprint sampled once every thread is blocked
+static void park(size_t num_threads, size_t cases, memory_t* before, memory_t* after)
+{
+    size_t num_channels = cases == 0 ? 1 : cases;
+    channel_t** channels = malloc(sizeof(channel_t*) * num_channels);
+    select_t* select_list = malloc(sizeof(select_t) * num_channels * num_threads);
+    parked_args_t* args = malloc(sizeof(parked_args_t) * num_threads);
+    pthread_t* pid = malloc(sizeof(pthread_t) * num_threads);
+    assert(channels != NULL && select_list != NULL && args != NULL && pid != NULL);
+    for (size_t i = 0; i < num_channels; i++) {
+        channels[i] = channel_create(1);
+        assert(channels[i] != NULL);
+    }
+    for (size_t t = 0; t < num_threads; t++) {
+        for (size_t i = 0; i < num_channels; i++) {
+            select_list[t * num_channels + i].channel = channels[i];
+            select_list[t * num_channels + i].dir = RECV;
+            select_list[t * num_channels + i].data = NULL;
+        }
+    }
+    sem_t started;
+    sem_init(&started, 0, 0);
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, PARKED_STACK_SIZE);
+
+    malloc_trim(0);
+    memory_sample(before);
+    for (size_t t = 0; t < num_threads; t++) {
+        args[t].select_list = &select_list[t * num_channels];
+        args[t].select_count = num_channels;
+        args[t].channel = channels[0];
+        args[t].started = &started;
+        int pthread_status = pthread_create(&pid[t], &attr, cases == 0 ? parked_receive : parked_select, &args[t]);
+        assert(pthread_status == 0);
+    }
+    for (size_t t = 0; t < num_threads; t++) {
+        sem_wait(&started);
+    }
+    if (cases == 0) {
+        // receivers cannot be observed blocking, so give them time to reach pthread_cond_wait
+        usleep(100000);
+    } else {
+        while (registrations(channels, num_channels) < num_threads * num_channels) {
+            usleep(1000);
+        }
+    }
+    memory_sample(after);
+
+    for (size_t i = 0; i < num_channels; i++) {
+        channel_close(channels[i]);
+    }
+    for (size_t t = 0; t < num_threads; t++) {
+        pthread_join(pid[t], NULL);
+    }
+    for (size_t i = 0; i < num_channels; i++) {
+        channel_destroy(channels[i]);
+    }
+    pthread_attr_destroy(&attr);
+    sem_destroy(&started);
+    free(pid);
+    free(args);
+    free(select_list);
+    free(channels);
+}
+
+// Reports the footprint of a blocked receiver and of one select registration
+static void waiter_footprint(size_t num_threads, size_t cases)
+{
+    memory_t before;
+    memory_t receive;
+    memory_t select;
+    // the first round starts with a cold stack cache, so it shows what a new blocked thread really costs
+    park(num_threads, 0, &before, &receive);
+    double waiter_rss = per_item(receive.rss, before.rss, num_threads);
+    double waiter_heap = per_item(receive.heap, before.heap, num_threads);
+    // the next two rounds reuse cached stacks alike, so their difference is the select registrations alone
+    park(num_threads, 0, &before, &receive);
+    double receive_rss = per_item(receive.rss, before.rss, num_threads);
+    double receive_heap = per_item(receive.heap, before.heap, num_threads);
+    park(num_threads, cases, &before, &select);
+    double select_rss = per_item(select.rss, before.rss, num_threads);
+    double select_heap = per_item(select.heap, before.heap, num_threads);
+
+    char case_name[128];
+    snprintf(case_name, sizeof(case_name), "receive waiter threads=%zu", num_threads);
+    report_row(case_name, "B/waiter", waiter_rss, waiter_heap);
+    snprintf(case_name, sizeof(case_name), "select registration cases=%zu", cases);
+    report_row(case_name, "B/registration", (select_rss - receive_rss) / (double)cases, (select_heap - receive_heap) / (double)cases);
+}
+
+// Creates and destroys channels of mixed capacities in an interleaved order, then reports how much heap
+// is held by the allocator but unused, and how much RSS is not returned after every channel is gone
+static void churn_fragmentation(size_t count)
+{
+    static const size_t capacities[] = {1, 7, 64, 300, 1024};
+    size_t num_capacities = sizeof(capacities) / sizeof(size_t);
+    channel_t** channels = malloc(sizeof(channel_t*) * count);
+    assert(channels != NULL);
+    memory_t before;
+    memory_t live;
+    memory_t after;
+    malloc_trim(0);
+    memory_sample(&before);
+    for (size_t i = 0; i < count; i++) {
+        channels[i] = channel_create(capacities[i % num_capacities]);
+    }
+    for (size_t round = 1; round <= 4; round++) {
+        // free every other channel, then refill the holes with a different capacity
+        for (size_t i = round % 2; i < count; i += 2) {
+            channel_close(channels[i]);
+            channel_destroy(channels[i]);
+            channels[i] = channel_create(capacities[(i + round) % num_capacities]);
+        }
+    }
+    memory_sample(&live);
+    for (size_t i = 0; i < count; i += 2) {
+        channel_close(channels[i]);
+        channel_destroy(channels[i]);
+    }
+    memory_sample(&after);
+    for (size_t i = 1; i < count; i += 2) {
+        channel_close(channels[i]);
+        channel_destroy(channels[i]);
+    }
+    free(channels);
+    memory_t empty;
+    memory_sample(&empty);
+
+    char case_name[128];
+    snprintf(case_name, sizeof(case_name), "churn n=%zu half destroyed", count);
+    static const char* const names[] = {"live_heap", "arena", "free_in_arena_pct"};
+    double free_pct = after.arena > 0 ? 100.0 * (double)(after.arena - after.heap) / (double)after.arena : 0.0;
+    double values[] = {(double)(live.heap - before.heap), (double)after.arena, free_pct};
+    bench_report_values("memory", case_name, "B", names, values, 3);
+    snprintf(case_name, sizeof(case_name), "churn n=%zu all destroyed", count);
+    static const char* const empty_names[] = {"rss_retained", "arena"};
+    double empty_values[] = {(double)empty.rss - (double)before.rss, (double)empty.arena};
+    bench_report_values("memory", case_name, "B", empty_names, empty_values, 2);
+    if (bench_config.format == BENCH_TEXT) {
+        fprintf(bench_report_file(), "churn n=%zu: half destroyed arena %zu B, %.1f%% free in arena; all destroyed RSS retained %.0f B\n",
+                count, after.arena, free_pct, (double)empty.rss - (double)before.rss);
+    }
+}
+
+// Reports resident and heap bytes per channel, per thread blocked in channel_receive,
+// per channel_select registration, and heap fragmentation left behind by channel_destroy churn
+void bench_memory()
+{
+    static const size_t counts[] = {1000, 10000, 100000, 1000000};
+    static const size_t quick_counts[] = {1000, 100000};
+    static const size_t capacities[] = {1, 16, 256};
+    const size_t* count_list = bench_config.quick ? quick_counts : counts;
+    size_t num_counts = bench_config.quick ? sizeof(quick_counts) / sizeof(size_t) : sizeof(counts) / sizeof(size_t);
+    size_t num_threads = bench_config.quick ? 200 : 2000;
+
+    if (bench_config.format == BENCH_TEXT) {
+        fprintf(bench_report_file(), "\n== memory ==\n%-40s %-14s %12s %12s\n", "case", "unit", "rss", "heap");
+    }
+    for (size_t c = 0; c < num_counts; c++) {
+        for (size_t k = 0; k < sizeof(capacities) / sizeof(size_t); k++) {
+            // keep the largest points under a few hundred megabytes
+            if (count_list[c] * capacities[k] > 16000000) {
+                continue;
+            }
+            channel_footprint(count_list[c], capacities[k]);
+        }
+    }
+    waiter_footprint(num_threads, 16);
+    churn_fragmentation(bench_config.quick ? 20000 : 200000);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_MEMORY_H
+#define BENCH_MEMORY_H
+
+// Reports resident and heap bytes per channel, per thread blocked in channel_receive,
+// per channel_select registration, and heap fragmentation left behind by channel_destroy churn
+void bench_memory();
+
+#endif // BENCH_MEMORY_H
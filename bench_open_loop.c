@@ -0,0 +1,191 @@
+#include <pthread.h>
+#include <sched.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include "channel.h"
+#include "bench_util.h"
+#include "bench_open_loop.h"
+
+typedef struct {
+    channel_t* in;
+    channel_t* out;
+} stage_args_t;
+
+typedef struct {
+    channel_t* in;
+    size_t count;
+    const uint64_t* intended;
+    const uint64_t* actual;
+    bench_hist_t* corrected;
+    bench_hist_t* uncorrected;
+    uint64_t end_ns;
+} sink_args_t;
+
+// Forwards messages from one channel to the next until it sees NULL, which it forwards too
+static void* stage(void* arg)
+{
+    stage_args_t* args = arg;
+    while (true) {
+        void* data = NULL;
+        enum channel_status status = channel_receive(args->in, &data);
+        assert(status == SUCCESS);
+        status = channel_send(args->out, data);
+        assert(status == SUCCESS);
+        if (data == NULL) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// Drains the last channel and records the end-to-end latency of every message
+static void* sink(void* arg)
+{
+    sink_args_t* args = arg;
+    for (size_t i = 0; i < args->count; i++) {
+        void* data = NULL;
+        enum channel_status status = channel_receive(args->in, &data);
+        assert(status == SUCCESS);
+        assert(data != NULL);
+        uint64_t now = bench_now_ns();
+        size_t index = (size_t)data - 1;
+        // measured from when the message should have been sent, so a stalled generator cannot hide the delay
+        bench_hist_record(args->corrected, now - args->intended[index]);
+        bench_hist_record(args->uncorrected, now - args->actual[index]);
+    }
+    args->end_ns = bench_now_ns();
+    void* data = NULL;
+    enum channel_status status = channel_receive(args->in, &data);
+    assert(status == SUCCESS && data == NULL);
+    return NULL;
+}
+
+// Returns a uniform double in (0, 1] from a xorshift64 state
+static double next_uniform(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return ((double)(*state >> 11) + 1.0) / 9007199254740992.0;
+}
+
+// Waits until the monotonic clock reaches the given time, sleeping for long gaps and yielding for short ones
+static void wait_until(uint64_t deadline)
+{
+    uint64_t now = bench_now_ns();
+    if (deadline > now + 100000) {
+        uint64_t gap = deadline - now - 50000;
+        struct timespec ts = {(time_t)(gap / 1000000000ull), (long)(gap % 1000000000ull)};
+        nanosleep(&ts, NULL);
+    }
+    while (bench_now_ns() < deadline) {
+        sched_yield();
+    }
+}
+
+static void run_case(double rate, bool poisson, size_t depth)
+{
+    // one second of traffic per point, bounded by the configured message count
+    size_t count = (size_t)(rate * (bench_config.quick ? 0.2 : 1.0));
+    if (count > bench_config.messages) {
+        count = bench_config.messages;
+    }
+    if (count == 0) {
+        count = 1;
+    }
+    uint64_t* intended = malloc(sizeof(uint64_t) * count);
+    uint64_t* actual = malloc(sizeof(uint64_t) * count);
+    bench_hist_t* corrected = malloc(sizeof(bench_hist_t));
+    bench_hist_t* uncorrected = malloc(sizeof(bench_hist_t));
+    channel_t** channels = malloc(sizeof(channel_t*) * depth);
+    stage_args_t* stage_args = malloc(sizeof(stage_args_t) * depth);
+    pthread_t* pid = malloc(sizeof(pthread_t) * depth);
+    assert(intended && actual && corrected && uncorrected && channels && stage_args && pid);
+    bench_hist_reset(corrected);
+    bench_hist_reset(uncorrected);
+    for (size_t i = 0; i < depth; i++) {
+        channels[i] = channel_create(64);
+        assert(channels[i] != NULL);
+    }
+    // depth channels are joined by depth - 1 forwarding stages, then drained by the sink
+    for (size_t i = 0; i + 1 < depth; i++) {
+        stage_args[i].in = channels[i];
+        stage_args[i].out = channels[i + 1];
+        int pthread_status = pthread_create(&pid[i], NULL, stage, &stage_args[i]);
+        assert(pthread_status == 0);
+    }
+    sink_args_t sink_args = {channels[depth - 1], count, intended, actual, corrected, uncorrected, 0};
+    int pthread_status = pthread_create(&pid[depth - 1], NULL, sink, &sink_args);
+    assert(pthread_status == 0);
+
+    uint64_t seed = 0x9e3779b97f4a7c15ull;
+    double interval = 1e9 / rate;
+    uint64_t start = bench_now_ns() + 1000000;
+    double offset = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        intended[i] = start + (uint64_t)offset;
+        wait_until(intended[i]);
+        actual[i] = bench_now_ns();
+        enum channel_status status = channel_send(channels[0], (void*)(i + 1));
+        assert(status == SUCCESS);
+        offset += poisson ? -log(next_uniform(&seed)) * interval : interval;
+    }
+    enum channel_status status = channel_send(channels[0], NULL);
+    assert(status == SUCCESS);
+    for (size_t i = 0; i < depth; i++) {
+        pthread_join(pid[i], NULL);
+    }
+    double achieved = (double)count * 1e9 / (double)(sink_args.end_ns - start);
+
+    const char* arrivals = poisson ? "poisson" : "const";
+    char case_name[128];
+    if (bench_config.format == BENCH_TEXT) {
+        snprintf(case_name, sizeof(case_name), "d%zu %s %.0f/s got %.0f/s corrected", depth, arrivals, rate, achieved);
+        bench_report_latency("open_loop", case_name, corrected);
+        snprintf(case_name, sizeof(case_name), "d%zu %s %.0f/s got %.0f/s uncorrected", depth, arrivals, rate, achieved);
+        bench_report_latency("open_loop", case_name, uncorrected);
+    } else {
+        // machine-readable case names stay stable across runs; the achieved rate becomes a value of its own
+        static const char* const names[] = {"achieved"};
+        snprintf(case_name, sizeof(case_name), "d%zu %s %.0f/s", depth, arrivals, rate);
+        bench_report_values("open_loop", case_name, "msg/s", names, &achieved, 1);
+        snprintf(case_name, sizeof(case_name), "d%zu %s %.0f/s corrected", depth, arrivals, rate);
+        bench_report_latency("open_loop", case_name, corrected);
+        snprintf(case_name, sizeof(case_name), "d%zu %s %.0f/s uncorrected", depth, arrivals, rate);
+        bench_report_latency("open_loop", case_name, uncorrected);
+    }
+
+    for (size_t i = 0; i < depth; i++) {
+        channel_close(channels[i]);
+        channel_destroy(channels[i]);
+    }
+    free(pid);
+    free(stage_args);
+    free(channels);
+    free(uncorrected);
+    free(corrected);
+    free(actual);
+    free(intended);
+}
+
+// Drives a pipeline of channels at fixed target rates with constant or Poisson arrivals
+// and reports latency measured from each message's intended send time, which corrects for coordinated omission
+void bench_open_loop()
+{
+    static const double rates[] = {1e4, 5e4, 1e5, 2e5, 5e5, 1e6, 2e6};
+    static const double quick_rates[] = {1e4, 1e5, 1e6};
+
+    const double* rate_list = bench_config.quick ? quick_rates : rates;
+    size_t num_rates = bench_config.quick ? sizeof(quick_rates) / sizeof(double) : sizeof(rates) / sizeof(double);
+    size_t depth = bench_config.pipeline_depth > 0 ? bench_config.pipeline_depth : 1;
+
+    bench_report_latency_header("open_loop");
+    for (int poisson = 0; poisson < 2; poisson++) {
+        for (size_t r = 0; r < num_rates; r++) {
+            run_case(rate_list[r], poisson == 1, depth);
+        }
+    }
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_OPEN_LOOP_H
+#define BENCH_OPEN_LOOP_H
+
+// Drives a pipeline of channels at fixed target rates with constant or Poisson arrivals
+// and reports latency measured from each message's intended send time, which corrects for coordinated omission
+void bench_open_loop();
+
+#endif // BENCH_OPEN_LOOP_H
@@ -0,0 +1,313 @@
+#include <pthread.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "channel.h"
+#include "bench_util.h"
+#include "bench_oversub.h"
+
+// Iterations a spin-then-park waiter polls before it yields once and parks on the futex
+// Kept short: with more runnable threads than cores a long spin burns the time slice the peer needs to make progress
+#define SPIN_ITERATIONS 64
+
+// Defines a wait policy as a bounded queue of pointer-sized messages that blocks with that policy
+typedef struct {
+    const char* name;
+    void* (*create)(size_t capacity);
+    void (*send)(void* queue, uintptr_t value);
+    uintptr_t (*receive)(void* queue);
+    void (*destroy)(void* queue);
+} policy_t;
+
+static void* condvar_create(size_t capacity)
+{
+    return channel_create(capacity);
+}
+
+static void condvar_send(void* queue, uintptr_t value)
+{
+    enum channel_status status = channel_send(queue, (void*)value);
+    assert(status == SUCCESS);
+}
+
+static uintptr_t condvar_receive(void* queue)
+{
+    void* data = NULL;
+    enum channel_status status = channel_receive(queue, &data);
+    assert(status == SUCCESS);
+    return (uintptr_t)data;
+}
+
+static void condvar_destroy(void* queue)
+{
+    channel_close(queue);
+    channel_destroy(queue);
+}
+
+// A mutex-protected ring like channel_t, but whose waiters sleep on a futex sequence word
+// instead of a condition variable, optionally spinning on the word first
+typedef struct {
+    pthread_mutex_t mutex;
+    atomic_uint seq;
+    atomic_uint waiters;
+    size_t spin;
+    size_t capacity;
+    size_t head;
+    size_t size;
+    uintptr_t* data;
+} futex_queue_t;
+
+static void* futex_queue_create_spin(size_t capacity, size_t spin)
+{
+    futex_queue_t* queue = malloc(sizeof(futex_queue_t));
+    assert(queue != NULL);
+    pthread_mutex_init(&queue->mutex, NULL);
+    atomic_init(&queue->seq, 0);
+    atomic_init(&queue->waiters, 0);
+    queue->spin = spin;
+    queue->capacity = capacity;
+    queue->head = 0;
+    queue->size = 0;
+    queue->data = malloc(sizeof(uintptr_t) * capacity);
+    assert(queue->data != NULL);
+    return queue;
+}
+
+static void* futex_create(size_t capacity)
+{
+    return futex_queue_create_spin(capacity, 0);
+}
+
+static void* spin_park_create(size_t capacity)
+{
+    return futex_queue_create_spin(capacity, SPIN_ITERATIONS);
+}
+
+// Waits until seq moves past the value observed under the lock
+static void futex_queue_wait(futex_queue_t* queue, unsigned seen)
+{
+    for (size_t i = 0; i < queue->spin; i++) {
+        if (atomic_load_explicit(&queue->seq, memory_order_acquire) != seen) {
+            return;
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    if (queue->spin > 0) {
+        // give a peer waiting for this core one chance to run before paying for the futex round trip
+        sched_yield();
+        if (atomic_load_explicit(&queue->seq, memory_order_acquire) != seen) {
+            return;
+        }
+    }
+    atomic_fetch_add(&queue->waiters, 1);
+    // the kernel rechecks seq against seen, so a wake between the unlock and this call is not lost
+    syscall(SYS_futex, &queue->seq, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+    atomic_fetch_sub(&queue->waiters, 1);
+}
+
+// Publishes a state change and wakes any parked waiter
+static void futex_queue_wake(futex_queue_t* queue)
+{
+    atomic_fetch_add_explicit(&queue->seq, 1, memory_order_release);
+    if (atomic_load(&queue->waiters) > 0) {
+        syscall(SYS_futex, &queue->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+static void futex_send(void* arg, uintptr_t value)
+{
+    futex_queue_t* queue = arg;
+    while (true) {
+        pthread_mutex_lock(&queue->mutex);
+        if (queue->size < queue->capacity) {
+            queue->data[(queue->head + queue->size) % queue->capacity] = value;
+            queue->size++;
+            pthread_mutex_unlock(&queue->mutex);
+            futex_queue_wake(queue);
+            return;
+        }
+        unsigned seen = atomic_load(&queue->seq);
+        pthread_mutex_unlock(&queue->mutex);
+        futex_queue_wait(queue, seen);
+    }
+}
+
+static uintptr_t futex_receive(void* arg)
+{
+    futex_queue_t* queue = arg;
+    while (true) {
+        pthread_mutex_lock(&queue->mutex);
+        if (queue->size > 0) {
+            uintptr_t value = queue->data[queue->head];
+            queue->head = (queue->head + 1) % queue->capacity;
+            queue->size--;
+            pthread_mutex_unlock(&queue->mutex);
+            futex_queue_wake(queue);
+            return value;
+        }
+        unsigned seen = atomic_load(&queue->seq);
+        pthread_mutex_unlock(&queue->mutex);
+        futex_queue_wait(queue, seen);
+    }
+}
+
+static void futex_destroy(void* arg)
+{
+    futex_queue_t* queue = arg;
+    pthread_mutex_destroy(&queue->mutex);
+    free(queue->data);
+    free(queue);
+}
+
+static const policy_t policies[] = {
+    {"condvar", condvar_create, condvar_send, condvar_receive, condvar_destroy},
+    {"futex", futex_create, futex_send, futex_receive, futex_destroy},
+    {"spin-then-park", spin_park_create, futex_send, futex_receive, futex_destroy},
+};
+
+typedef struct {
+    const policy_t* policy;
+    void* ping;
+    void* pong;
+    size_t rounds;
+    bench_hist_t hist;
+} pair_args_t;
+
+static void* echo(void* arg)
+{
+    pair_args_t* args = arg;
+    for (size_t i = 0; i < args->rounds; i++) {
+        args->policy->send(args->pong, args->policy->receive(args->ping));
+    }
+    return NULL;
+}
+
+static void* initiator(void* arg)
+{
+    pair_args_t* args = arg;
+    for (size_t i = 1; i <= args->rounds; i++) {
+        uint64_t t = bench_ticks();
+        args->policy->send(args->ping, i);
+        uintptr_t value = args->policy->receive(args->pong);
+        t = bench_ticks() - t;
+        assert(value == i);
+        bench_hist_record(&args->hist, bench_ticks_to_ns(t));
+    }
+    return NULL;
+}
+
+static atomic_bool hog_stop;
+
+// Burns CPU until told to stop, standing in for unrelated work sharing the cores
+static void* hog(void* arg)
+{
+    (void)arg;
+    volatile uint64_t sink = 0;
+    while (!atomic_load_explicit(&hog_stop, memory_order_relaxed)) {
+        sink++;
+    }
+    return NULL;
+}
+
+// Runs one policy with the given number of pairs and hogs, reports its latency row and returns round trips/s
+static double run_case(const policy_t* policy, size_t num_pairs, size_t num_hogs, const char* case_name)
+{
+    size_t rounds = bench_config.messages / num_pairs / 4;
+    if (rounds < 100) {
+        rounds = 100;
+    }
+    pair_args_t* pairs = malloc(sizeof(pair_args_t) * num_pairs);
+    pthread_t* pid = malloc(sizeof(pthread_t) * (num_pairs * 2 + num_hogs));
+    bench_hist_t* hist = malloc(sizeof(bench_hist_t));
+    assert(pairs != NULL && pid != NULL && hist != NULL);
+    atomic_store(&hog_stop, false);
+    for (size_t i = 0; i < num_hogs; i++) {
+        int pthread_status = pthread_create(&pid[num_pairs * 2 + i], NULL, hog, NULL);
+        assert(pthread_status == 0);
+    }
+    uint64_t t = bench_now_ns();
+    for (size_t i = 0; i < num_pairs; i++) {
+        pairs[i].policy = policy;
+        pairs[i].ping = policy->create(1);
+        pairs[i].pong = policy->create(1);
+        pairs[i].rounds = rounds;
+        bench_hist_reset(&pairs[i].hist);
+        int pthread_status = pthread_create(&pid[2 * i], NULL, echo, &pairs[i]);
+        assert(pthread_status == 0);
+        pthread_status = pthread_create(&pid[2 * i + 1], NULL, initiator, &pairs[i]);
+        assert(pthread_status == 0);
+    }
+    bench_hist_reset(hist);
+    for (size_t i = 0; i < num_pairs; i++) {
+        pthread_join(pid[2 * i], NULL);
+        pthread_join(pid[2 * i + 1], NULL);
+        bench_hist_merge(hist, &pairs[i].hist);
+    }
+    t = bench_now_ns() - t;
+    atomic_store(&hog_stop, true);
+    for (size_t i = 0; i < num_hogs; i++) {
+        pthread_join(pid[num_pairs * 2 + i], NULL);
+    }
+    for (size_t i = 0; i < num_pairs; i++) {
+        policy->destroy(pairs[i].ping);
+        policy->destroy(pairs[i].pong);
+    }
+
+    double throughput = (double)(rounds * num_pairs) * 1e9 / (double)t;
+    bench_report_latency("oversub", case_name, hist);
+    static const char* const names[] = {"round_trips"};
+    bench_report_values("oversub", case_name, "op/s", names, &throughput, 1);
+    free(hist);
+    free(pid);
+    free(pairs);
+    return throughput;
+}
+
+// Runs many more ping-pong pairs than cores next to a CPU-hog load and reports round-trip percentiles
+// and throughput for the condvar wait of channel_t and for futex and spin-then-park waits
+void bench_oversub()
+{
+    static const size_t factors[] = {1, 4, 8};
+    static const size_t quick_factors[] = {4};
+    const size_t* factor_list = bench_config.quick ? quick_factors : factors;
+    size_t num_factors = bench_config.quick ? sizeof(quick_factors) / sizeof(size_t) : sizeof(factors) / sizeof(size_t);
+    size_t cores = bench_num_cpus();
+    size_t num_policies = sizeof(policies) / sizeof(policies[0]);
+    size_t num_cases = num_policies * num_factors * 2;
+    char (*case_names)[128] = malloc(sizeof(*case_names) * num_cases);
+    double* throughput = malloc(sizeof(double) * num_cases);
+    assert(case_names != NULL && throughput != NULL);
+
+    bench_report_latency_header("oversub");
+    size_t c = 0;
+    for (size_t p = 0; p < num_policies; p++) {
+        for (size_t f = 0; f < num_factors; f++) {
+            // each pair is two threads, so factor counts threads per core
+            size_t num_pairs = cores * factor_list[f] / 2 > 0 ? cores * factor_list[f] / 2 : 1;
+            // once alone, then with a hog on every core
+            size_t hogs[] = {0, cores};
+            for (size_t h = 0; h < 2; h++) {
+                snprintf(case_names[c], sizeof(case_names[c]), "%s pairs=%zu hogs=%zu", policies[p].name, num_pairs, hogs[h]);
+                throughput[c] = run_case(&policies[p], num_pairs, hogs[h], case_names[c]);
+                c++;
+            }
+        }
+    }
+    if (bench_config.format == BENCH_TEXT) {
+        fprintf(bench_report_file(), "\n== oversub throughput ==\n%-40s %14s\n", "case", "round trips/s");
+        for (size_t i = 0; i < c; i++) {
+            fprintf(bench_report_file(), "%-40s %14.0f\n", case_names[i], throughput[i]);
+        }
+        fflush(bench_report_file());
+    }
+    free(throughput);
+    free(case_names);
+}
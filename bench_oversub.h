@@ -0,0 +1,8 @@
+#ifndef BENCH_OVERSUB_H
+#define BENCH_OVERSUB_H
+
+// Runs many more ping-pong pairs than cores next to a CPU-hog load and reports round-trip percentiles
+// and throughput for the condvar wait of channel_t and for futex and spin-then-park waits
+void bench_oversub();
+
+#endif // BENCH_OVERSUB_H
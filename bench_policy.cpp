@@ -0,0 +1,127 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include "channel.hpp"
+#include "channel_policy.hpp"
+#include "bench_policy.h"
+
+extern "C" {
+#include "bench_util.h"
+}
+
+namespace {
+
+constexpr size_t policy_capacity = 64;
+
+// Moves total messages from num_producers to num_consumers through one channel made by make_channel
+// Returns the achieved rate in messages/sec
+template <typename Channel, typename Make>
+double run_once(Make make_channel, size_t num_producers, size_t num_consumers, size_t total)
+{
+    std::unique_ptr<Channel> channel = make_channel();
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, (unsigned)(num_producers + num_consumers + 1));
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < num_producers; p++) {
+        threads.emplace_back([&channel, &start, count = total / num_producers] {
+            pthread_barrier_wait(&start);
+            for (size_t i = 1; i <= count; i++) {
+                enum channel_status status = channel->send(i);
+                assert(status == SUCCESS);
+                (void)status;
+            }
+        });
+    }
+    for (size_t c = 0; c < num_consumers; c++) {
+        threads.emplace_back([&channel, &start, count = total / num_consumers] {
+            pthread_barrier_wait(&start);
+            for (size_t i = 0; i < count; i++) {
+                size_t value = 0;
+                enum channel_status status = channel->receive(value);
+                assert(status == SUCCESS && value != 0);
+                (void)status;
+            }
+        });
+    }
+    pthread_barrier_wait(&start);
+    uint64_t start_ns = bench_now_ns();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    uint64_t t = bench_now_ns() - start_ns;
+    pthread_barrier_destroy(&start);
+    return (double)total * 1e9 / (double)t;
+}
+
+template <typename Channel, typename Make>
+void run_case(const char* name, Make make_channel, const char* pattern, size_t num_producers, size_t num_consumers)
+{
+    // every producer and every consumer handles an equal share
+    size_t unit = num_producers * num_consumers;
+    size_t total = (bench_config.messages / unit) * unit;
+    if (total == 0) {
+        total = unit;
+    }
+    for (size_t i = 0; i < bench_config.warmup; i++) {
+        run_once<Channel>(make_channel, num_producers, num_consumers, total);
+    }
+    std::vector<double> samples(bench_config.reps);
+    for (size_t i = 0; i < bench_config.reps; i++) {
+        samples[i] = run_once<Channel>(make_channel, num_producers, num_consumers, total);
+    }
+    bench_stats_t stats;
+    bench_stats_compute(samples.data(), bench_config.reps, &stats);
+
+    char case_name[128];
+    snprintf(case_name, sizeof(case_name), "%s %s p=%zu c=%zu cap=%zu", name, pattern, num_producers, num_consumers, policy_capacity);
+    bench_report("policy", case_name, "msg/s", &stats);
+}
+
+template <typename Channel, typename Make>
+void run_patterns(const char* name, Make make_channel)
+{
+    size_t threads = bench_config.quick ? 2 : 4;
+    run_case<Channel>(name, make_channel, "spsc", 1, 1);
+    run_case<Channel>(name, make_channel, "mpmc", threads, threads);
+}
+
+template <typename Backend, typename Wait, typename Lock, typename... Args>
+void run_policy(const char* name, Args... args)
+{
+    using Channel = chan::policy::Channel<size_t, Backend, Wait, Lock>;
+    run_patterns<Channel>(name, [args...] { return std::make_unique<Channel>(args...); });
+}
+
+// Every lock policy with the given wait policy on an inline ring
+template <typename Wait>
+void run_locks(const char* wait_name)
+{
+    using Ring = chan::policy::InlineRing<policy_capacity>;
+    char name[64];
+    snprintf(name, sizeof(name), "mutex/%s", wait_name);
+    run_policy<Ring, Wait, chan::policy::MutexLock>(name);
+    snprintf(name, sizeof(name), "spin/%s", wait_name);
+    run_policy<Ring, Wait, chan::policy::SpinLock>(name);
+    snprintf(name, sizeof(name), "ticket/%s", wait_name);
+    run_policy<Ring, Wait, chan::policy::TicketLock>(name);
+    snprintf(name, sizeof(name), "mcs/%s", wait_name);
+    run_policy<Ring, Wait, chan::policy::McsLock>(name);
+}
+
+} // namespace
+
+// Measures messages/sec of the policy-based C++ channel for every lock and wait policy pair, on inline and heap
+// rings, next to the C++ front-end over channel.c, for SPSC and MPMC traffic
+void bench_policy()
+{
+    bench_report_header("policy");
+    run_patterns<chan::Channel<size_t>>("channel.c", [] { return std::make_unique<chan::Channel<size_t>>(policy_capacity); });
+    run_locks<chan::policy::CondvarWait>("condvar");
+    run_locks<chan::policy::FutexWait>("futex");
+    run_locks<chan::policy::SpinWait>("spin");
+    run_policy<chan::policy::HeapRing, chan::policy::FutexWait, chan::policy::MutexLock>("mutex/futex heap", policy_capacity);
+}
@@ -0,0 +1,16 @@
+#ifndef BENCH_POLICY_H
+#define BENCH_POLICY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Measures messages/sec of the policy-based C++ channel for every lock and wait policy pair, on inline and heap
+// rings, next to the C++ front-end over channel.c, for SPSC and MPMC traffic
+void bench_policy();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BENCH_POLICY_H
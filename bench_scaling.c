@@ -0,0 +1,267 @@
+#include <pthread.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "channel.h"
+#include "bench_util.h"
+#include "bench_scaling.h"
+
+enum workload {
+    // every thread sends then receives on one shared channel
+    SHARED,
+    // every thread sends then receives on its own channel
+    PRIVATE,
+    // half the threads send and half receive on one shared channel
+    HANDOFF
+};
+
+enum placement {
+    // fill both hyperthreads of a core before moving to the next core
+    SMT,
+    // one thread per physical core of the first socket before using siblings
+    SOCKET,
+    // alternate sockets for consecutive threads
+    CROSS
+};
+
+typedef struct {
+    size_t cpu;
+    size_t package;
+    size_t core;
+    size_t sibling;
+} cpu_info_t;
+
+typedef struct {
+    channel_t* send;
+    channel_t* recv;
+    size_t ops;
+    size_t cpu;
+    bool sender;
+    bool receiver;
+    pthread_barrier_t* start;
+    uint64_t start_ns;
+    uint64_t end_ns;
+} scaling_args_t;
+
+static size_t read_topology_value(size_t cpu, const char* name)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/topology/%s", cpu, name);
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    size_t value = 0;
+    if (fscanf(file, "%zu", &value) != 1) {
+        value = 0;
+    }
+    fclose(file);
+    return value;
+}
+
+static enum placement sort_placement;
+
+// Fills keys with the sort order of a CPU under the current placement, most significant first
+static void placement_keys(const cpu_info_t* info, size_t keys[3])
+{
+    if (sort_placement == SMT) {
+        keys[0] = info->package;
+        keys[1] = info->core;
+        keys[2] = info->sibling;
+    } else if (sort_placement == SOCKET) {
+        keys[0] = info->package;
+        keys[1] = info->sibling;
+        keys[2] = info->core;
+    } else {
+        keys[0] = info->sibling;
+        keys[1] = info->core;
+        keys[2] = info->package;
+    }
+}
+
+static int compare_cpu(const void* a, const void* b)
+{
+    size_t keys_x[3];
+    size_t keys_y[3];
+    placement_keys(a, keys_x);
+    placement_keys(b, keys_y);
+    for (size_t i = 0; i < 3; i++) {
+        if (keys_x[i] != keys_y[i]) {
+            return keys_x[i] < keys_y[i] ? -1 : 1;
+        }
+    }
+    return (((const cpu_info_t*)a)->cpu > ((const cpu_info_t*)b)->cpu) - (((const cpu_info_t*)a)->cpu < ((const cpu_info_t*)b)->cpu);
+}
+
+// Fills cpus with the order in which threads are pinned under the given placement
+static void cpu_order(enum placement placement, size_t* cpus, size_t num_cpus)
+{
+    cpu_info_t* info = malloc(sizeof(cpu_info_t) * num_cpus);
+    assert(info != NULL);
+    for (size_t i = 0; i < num_cpus; i++) {
+        info[i].cpu = i;
+        info[i].package = read_topology_value(i, "physical_package_id");
+        info[i].core = read_topology_value(i, "core_id");
+        // the sibling rank is the number of lower-numbered CPUs sharing this core
+        info[i].sibling = 0;
+        for (size_t j = 0; j < i; j++) {
+            if (info[j].package == info[i].package && info[j].core == info[i].core) {
+                info[i].sibling++;
+            }
+        }
+    }
+    sort_placement = placement;
+    qsort(info, num_cpus, sizeof(cpu_info_t), compare_cpu);
+    for (size_t i = 0; i < num_cpus; i++) {
+        cpus[i] = info[i].cpu;
+    }
+    free(info);
+}
+
+static void* worker(void* arg)
+{
+    scaling_args_t* args = arg;
+    bench_pin_self(args->cpu);
+    pthread_barrier_wait(args->start);
+    args->start_ns = bench_now_ns();
+    for (size_t i = 1; i <= args->ops; i++) {
+        enum channel_status status;
+        if (args->sender) {
+            status = channel_send(args->send, (void*)i);
+            assert(status == SUCCESS);
+        }
+        if (args->receiver) {
+            void* data = NULL;
+            status = channel_receive(args->recv, &data);
+            assert(status == SUCCESS);
+        }
+    }
+    args->end_ns = bench_now_ns();
+    return NULL;
+}
+
+// Runs the workload once with num_threads threads pinned in cpus order
+// Returns the achieved rate in operations/sec, where one operation is one message sent and received
+static double run_once(enum workload workload, size_t num_threads, const size_t* cpus, size_t num_cpus, size_t ops)
+{
+    size_t num_channels = workload == PRIVATE ? num_threads : 1;
+    channel_t** channels = malloc(sizeof(channel_t*) * num_channels);
+    pthread_t* pid = malloc(sizeof(pthread_t) * num_threads);
+    scaling_args_t* args = malloc(sizeof(scaling_args_t) * num_threads);
+    assert(channels != NULL && pid != NULL && args != NULL);
+    for (size_t i = 0; i < num_channels; i++) {
+        channels[i] = channel_create(64);
+        assert(channels[i] != NULL);
+    }
+    // handoff pairs even senders with odd receivers; with an odd thread count there is one more sender, so the
+    // senders split the receivers' messages between them and every message sent is received
+    size_t num_senders = (num_threads + 1) / 2;
+    size_t num_receivers = num_threads / 2;
+    size_t total = workload == HANDOFF ? ops * num_receivers : ops * num_threads;
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, (unsigned)num_threads);
+    for (size_t i = 0; i < num_threads; i++) {
+        channel_t* channel = channels[workload == PRIVATE ? i : 0];
+        args[i].send = channel;
+        args[i].recv = channel;
+        args[i].ops = ops;
+        if (workload == HANDOFF && i % 2 == 0) {
+            args[i].ops = total / num_senders + (i / 2 < total % num_senders ? 1 : 0);
+        }
+        args[i].cpu = cpus[i % num_cpus];
+        args[i].sender = workload != HANDOFF || i % 2 == 0;
+        args[i].receiver = workload != HANDOFF || i % 2 == 1;
+        args[i].start = &start;
+        int pthread_status = pthread_create(&pid[i], NULL, worker, &args[i]);
+        assert(pthread_status == 0);
+    }
+    uint64_t first_start = UINT64_MAX;
+    uint64_t last_end = 0;
+    for (size_t i = 0; i < num_threads; i++) {
+        pthread_join(pid[i], NULL);
+        if (args[i].start_ns < first_start) {
+            first_start = args[i].start_ns;
+        }
+        if (args[i].end_ns > last_end) {
+            last_end = args[i].end_ns;
+        }
+    }
+    pthread_barrier_destroy(&start);
+    for (size_t i = 0; i < num_channels; i++) {
+        channel_close(channels[i]);
+        channel_destroy(channels[i]);
+    }
+    free(args);
+    free(pid);
+    free(channels);
+    return (double)total * 1e9 / (double)(last_end - first_start);
+}
+
+// Returns the next point of the 1, 2, 4 ... sweep, ending exactly at max_threads
+static size_t next_thread_count(size_t threads, size_t max_threads)
+{
+    if (threads < max_threads && threads * 2 > max_threads) {
+        return max_threads;
+    }
+    return threads * 2;
+}
+
+static const char* workload_name(enum workload workload)
+{
+    return workload == SHARED ? "shared" : workload == PRIVATE ? "private" : "handoff";
+}
+
+static const char* placement_name(enum placement placement)
+{
+    return placement == SMT ? "smt" : placement == SOCKET ? "socket" : "cross";
+}
+
+// Runs each channel workload at 1, 2, 4 ... N pinned threads under SMT-sibling, same-socket and cross-socket placement
+// and reports throughput, per-thread throughput and scaling efficiency against the smallest thread count
+void bench_scaling()
+{
+    size_t num_cpus = bench_num_cpus();
+    size_t* cpus = malloc(sizeof(size_t) * num_cpus);
+    double* samples = malloc(sizeof(double) * bench_config.reps);
+    assert(cpus != NULL && samples != NULL);
+    // sweep powers of two up to the CPU count, and always reach at least two threads so handoff has a point
+    size_t max_threads = num_cpus < 2 ? 2 : num_cpus;
+    size_t ops = bench_config.messages / 4;
+
+    if (bench_config.format == BENCH_TEXT) {
+        fprintf(bench_report_file(), "\n== scaling ==\n%-28s %8s %14s %14s %10s\n", "case", "threads", "op/s", "op/s/thread", "efficiency");
+    }
+    for (int p = SMT; p <= CROSS; p++) {
+        cpu_order((enum placement)p, cpus, num_cpus);
+        for (int w = SHARED; w <= HANDOFF; w++) {
+            double base_per_thread = 0.0;
+            for (size_t threads = w == HANDOFF ? 2 : 1; threads <= max_threads; threads = next_thread_count(threads, max_threads)) {
+                for (size_t i = 0; i < bench_config.warmup; i++) {
+                    run_once((enum workload)w, threads, cpus, num_cpus, ops);
+                }
+                for (size_t i = 0; i < bench_config.reps; i++) {
+                    samples[i] = run_once((enum workload)w, threads, cpus, num_cpus, ops);
+                }
+                bench_stats_t stats;
+                bench_stats_compute(samples, bench_config.reps, &stats);
+                double per_thread = stats.median / (double)threads;
+                if (base_per_thread == 0.0) {
+                    base_per_thread = per_thread;
+                }
+                double efficiency = per_thread / base_per_thread;
+
+                char case_name[128];
+                snprintf(case_name, sizeof(case_name), "%s %s", workload_name((enum workload)w), placement_name((enum placement)p));
+                if (bench_config.format == BENCH_TEXT) {
+                    fprintf(bench_report_file(), "%-28s %8zu %14.1f %14.1f %10.3f\n", case_name, threads, stats.median, per_thread, efficiency);
+                } else {
+                    static const char* const names[] = {"threads", "median", "stddev", "per_thread", "efficiency"};
+                    double values[] = {(double)threads, stats.median, stats.stddev, per_thread, efficiency};
+                    bench_report_values("scaling", case_name, "op/s", names, values, 5);
+                }
+            }
+        }
+    }
+    free(samples);
+    free(cpus);
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_SCALING_H
+#define BENCH_SCALING_H
+
+// Runs each channel workload at 1, 2, 4 ... N pinned threads under SMT-sibling, same-socket and cross-socket placement
+// and reports throughput, per-thread throughput and scaling efficiency against the smallest thread count
+void bench_scaling();
+
+#endif // BENCH_SCALING_H
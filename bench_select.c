@@ -0,0 +1,166 @@
+#include <pthread.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "channel.h"
+#include "bench_util.h"
+#include "bench_select.h"
+
+typedef struct {
+    channel_t** channels;
+    size_t num_cases;
+    channel_t* done_channel;
+    atomic_size_t* received;
+    size_t total;
+} selector_args_t;
+
+// Receives through channel_select over every channel until the done channel is closed
+// The selector that takes the last message closes the done channel
+static void* selector(void* arg)
+{
+    selector_args_t* args = arg;
+    select_t* select_list = malloc(sizeof(select_t) * (args->num_cases + 1));
+    assert(select_list != NULL);
+    for (size_t i = 0; i < args->num_cases; i++) {
+        select_list[i].channel = args->channels[i];
+        select_list[i].dir = RECV;
+        select_list[i].data = NULL;
+    }
+    select_list[args->num_cases].channel = args->done_channel;
+    select_list[args->num_cases].dir = RECV;
+    select_list[args->num_cases].data = NULL;
+    while (true) {
+        size_t selected_index;
+        enum channel_status status = channel_select(select_list, args->num_cases + 1, &selected_index);
+        if (status != SUCCESS) {
+            assert(status == CLOSED_ERROR);
+            break;
+        }
+        assert(selected_index < args->num_cases);
+        if (atomic_fetch_add(args->received, 1) + 1 == args->total) {
+            channel_close(args->done_channel);
+        }
+    }
+    free(select_list);
+    return NULL;
+}
+
+typedef struct {
+    double rate;
+    double cpu_per_op;
+    double wakeups_per_op;
+} select_sample_t;
+
+static select_sample_t run_once(size_t num_cases, size_t num_selectors, bool hot, size_t total)
+{
+    channel_t** channels = malloc(sizeof(channel_t*) * num_cases);
+    assert(channels != NULL);
+    for (size_t i = 0; i < num_cases; i++) {
+        channels[i] = channel_create(16);
+        assert(channels[i] != NULL);
+    }
+    channel_t* done_channel = channel_create(1);
+    assert(done_channel != NULL);
+    atomic_size_t received;
+    atomic_init(&received, 0);
+    selector_args_t args = {channels, num_cases, done_channel, &received, total};
+
+    bench_usage_t usage_start;
+    bench_usage_t usage_end;
+    bench_usage_process(&usage_start);
+    uint64_t t = bench_now_ns();
+    pthread_t* pid = malloc(sizeof(pthread_t) * num_selectors);
+    assert(pid != NULL);
+    for (size_t i = 0; i < num_selectors; i++) {
+        int pthread_status = pthread_create(&pid[i], NULL, selector, &args);
+        assert(pthread_status == 0);
+    }
+    for (size_t i = 1; i <= total; i++) {
+        // uniform traffic walks every channel, hot traffic only ever uses the last case
+        channel_t* target = hot ? channels[num_cases - 1] : channels[i % num_cases];
+        enum channel_status status = channel_send(target, (void*)i);
+        assert(status == SUCCESS);
+    }
+    for (size_t i = 0; i < num_selectors; i++) {
+        pthread_join(pid[i], NULL);
+    }
+    t = bench_now_ns() - t;
+    bench_usage_process(&usage_end);
+
+    channel_destroy(done_channel);
+    for (size_t i = 0; i < num_cases; i++) {
+        channel_close(channels[i]);
+        channel_destroy(channels[i]);
+    }
+    free(pid);
+    free(channels);
+
+    select_sample_t sample;
+    sample.rate = (double)total * 1e9 / (double)t;
+    sample.cpu_per_op = (double)(usage_end.cpu_ns - usage_start.cpu_ns) / (double)total;
+    sample.wakeups_per_op = (double)(usage_end.voluntary - usage_start.voluntary) / (double)total;
+    return sample;
+}
+
+static void run_case(size_t num_cases, size_t num_selectors, bool hot)
+{
+    // every select call touches every case, so shrink the run as cases grow to keep each point bounded
+    size_t total = bench_config.messages * 2 / num_cases;
+    if (total < 200) {
+        total = 200;
+    }
+    if (total > bench_config.messages) {
+        total = bench_config.messages;
+    }
+    for (size_t i = 0; i < bench_config.warmup; i++) {
+        run_once(num_cases, num_selectors, hot, total);
+    }
+    double* rate = malloc(sizeof(double) * bench_config.reps);
+    double* cpu = malloc(sizeof(double) * bench_config.reps);
+    double* wakeups = malloc(sizeof(double) * bench_config.reps);
+    assert(rate != NULL && cpu != NULL && wakeups != NULL);
+    for (size_t i = 0; i < bench_config.reps; i++) {
+        select_sample_t sample = run_once(num_cases, num_selectors, hot, total);
+        rate[i] = sample.rate;
+        cpu[i] = sample.cpu_per_op;
+        wakeups[i] = sample.wakeups_per_op;
+    }
+
+    char case_name[128];
+    bench_stats_t stats;
+    snprintf(case_name, sizeof(case_name), "%s cases=%zu selectors=%zu", hot ? "hot" : "uniform", num_cases, num_selectors);
+    bench_stats_compute(rate, bench_config.reps, &stats);
+    bench_report("select", case_name, "op/s", &stats);
+    bench_stats_compute(cpu, bench_config.reps, &stats);
+    bench_report("select", case_name, "cpu ns/op", &stats);
+    bench_stats_compute(wakeups, bench_config.reps, &stats);
+    bench_report("select", case_name, "wakeup/op", &stats);
+    free(rate);
+    free(cpu);
+    free(wakeups);
+}
+
+// Measures how channel_select scales with the number of cases, the number of concurrent selectors
+// and the spread of traffic across channels (uniform or one hot channel)
+void bench_select()
+{
+    static const size_t cases[] = {2, 16, 128, 1024, 10000};
+    static const size_t quick_cases[] = {2, 128, 10000};
+    static const size_t selectors[] = {1, 4, 16};
+    static const size_t quick_selectors[] = {1, 4};
+
+    const size_t* case_list = bench_config.quick ? quick_cases : cases;
+    size_t num_case_list = bench_config.quick ? sizeof(quick_cases) / sizeof(size_t) : sizeof(cases) / sizeof(size_t);
+    const size_t* selector_list = bench_config.quick ? quick_selectors : selectors;
+    size_t num_selector_list = bench_config.quick ? sizeof(quick_selectors) / sizeof(size_t) : sizeof(selectors) / sizeof(size_t);
+
+    bench_report_header("select");
+    for (int hot = 0; hot < 2; hot++) {
+        for (size_t c = 0; c < num_case_list; c++) {
+            for (size_t s = 0; s < num_selector_list; s++) {
+                run_case(case_list[c], selector_list[s], hot == 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_SELECT_H
+#define BENCH_SELECT_H
+
+// Measures how channel_select scales with the number of cases, the number of concurrent selectors
+// and the spread of traffic across channels (uniform or one hot channel)
+void bench_select();
+
+#endif // BENCH_SELECT_H
@@ -0,0 +1,64 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench_util.h"
+#include "stress_send_recv.h"
+#include "bench_send_recv.h"
+
+#define SEND_RECV_THREADS 8
+#define SEND_RECV_RINGS 2
+// Bytes behind each boxed message; every hop touches one byte per cache line
+#define SEND_RECV_PAYLOAD_SIZE 256
+
+// Runs the send/recv stress workload over single ring, multiple rings, all-to-all and tree topologies
+// with inline and boxed payloads, and reports the hops/sec achieved for each
+void bench_send_recv()
+{
+    struct {
+        const char* name;
+        enum send_recv_topology topology;
+    } topologies[] = {
+        {"ring", SEND_RECV_RING},
+        {"rings", SEND_RECV_MULTI_RING},
+        {"all-to-all", SEND_RECV_ALL_TO_ALL},
+        {"tree", SEND_RECV_TREE},
+    };
+    size_t capacities[] = {1, 16};
+    useconds_t duration_usec = bench_config.quick ? 20000 : 100000;
+    double* rates = malloc(sizeof(double) * bench_config.reps);
+    assert(rates != NULL);
+
+    bench_report_header("send_recv");
+    for (size_t t = 0; t < sizeof(topologies) / sizeof(topologies[0]); t++) {
+        for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); c++) {
+            for (int boxed = 0; boxed <= 1; boxed++) {
+                send_recv_config_t config = {
+                    .buffer_size = capacities[c],
+                    .num_threads = SEND_RECV_THREADS,
+                    .topology = topologies[t].topology,
+                    .num_rings = SEND_RECV_RINGS,
+                    .num_msgs = 0,
+                    .load = 0.5,
+                    .payload = boxed ? SEND_RECV_BOXED : SEND_RECV_INLINE,
+                    .payload_size = boxed ? SEND_RECV_PAYLOAD_SIZE : 0,
+                    .duration_usec = duration_usec,
+                };
+                send_recv_stats_t stats;
+                for (size_t w = 0; w < bench_config.warmup; w++) {
+                    run_stress_send_recv_config(&config, &stats);
+                }
+                for (size_t r = 0; r < bench_config.reps; r++) {
+                    run_stress_send_recv_config(&config, &stats);
+                    rates[r] = (double)stats.hops / stats.seconds;
+                }
+                char case_name[128];
+                snprintf(case_name, sizeof(case_name), "%s cap=%zu threads=%d %s", topologies[t].name, capacities[c],
+                         SEND_RECV_THREADS, boxed ? "boxed" : "inline");
+                bench_stats_t result;
+                bench_stats_compute(rates, bench_config.reps, &result);
+                bench_report("send_recv", case_name, "hop/s", &result);
+            }
+        }
+    }
+    free(rates);
+}
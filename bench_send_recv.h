@@ -0,0 +1,8 @@
+#ifndef BENCH_SEND_RECV_H
+#define BENCH_SEND_RECV_H
+
+// Runs the send/recv stress workload over single ring, multiple rings, all-to-all and tree topologies
+// with inline and boxed payloads, and reports the hops/sec achieved for each
+void bench_send_recv();
+
+#endif // BENCH_SEND_RECV_H
@@ -0,0 +1,108 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench_util.h"
+#include "topology_gen.h"
+#include "stress.h"
+#include "bench_stress.h"
+
+// Undirected links per node asked of the Erdős–Rényi and scale-free families
+#define STRESS_LINKS_PER_NODE 4
+
+// Runs the router stress test on generated ring, grid, Erdős–Rényi, scale-free and hub-and-spoke topologies
+// with one thread per router and with routers multiplexed on a task pool, and reports the time to convergence,
+// the distance vector updates exchanged and the entries they carried for each
+void bench_stress()
+{
+    enum topology_family families[] = {TOPOLOGY_RING, TOPOLOGY_GRID, TOPOLOGY_ERDOS_RENYI, TOPOLOGY_SCALE_FREE, TOPOLOGY_HUB};
+    size_t sizes[] = {32, 128, 512};
+    size_t num_sizes = bench_config.quick ? 1 : sizeof(sizes) / sizeof(sizes[0]);
+    double* convergence = malloc(sizeof(double) * bench_config.reps);
+    double* messages = malloc(sizeof(double) * bench_config.reps);
+    double* entries = malloc(sizeof(double) * bench_config.reps);
+    assert(convergence != NULL && messages != NULL && entries != NULL);
+
+    bench_report_header("stress");
+    for (size_t s = 0; s < num_sizes; s++) {
+        for (size_t f = 0; f < sizeof(families) / sizeof(families[0]); f++) {
+            size_t num_nodes = sizes[s];
+            topology_t* topology = topology_generate(families[f], num_nodes, STRESS_LINKS_PER_NODE * num_nodes, 1, num_nodes);
+            // one thread per router blocking in channel_select, or watch-driven tasks on one worker per CPU
+            struct {
+                const char* name;
+                size_t num_workers;
+            } modes[] = {{"threads", 0}, {"pool", bench_num_cpus()}};
+            for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+                stress_stats_t stats;
+                for (size_t w = 0; w < bench_config.warmup; w++) {
+                    run_stress_topology(1, 1, topology, modes[m].num_workers, &stats);
+                }
+                for (size_t r = 0; r < bench_config.reps; r++) {
+                    run_stress_topology(1, 1, topology, modes[m].num_workers, &stats);
+                    convergence[r] = (double)stats.convergence_ns / 1e6;
+                    messages[r] = (double)stats.messages;
+                    entries[r] = (double)stats.entries;
+                }
+                char case_name[128];
+                snprintf(case_name, sizeof(case_name), "%s n=%zu links=%zu %s", topology_family_name(families[f]), num_nodes,
+                         topology->num_edges / 2, modes[m].name);
+                bench_stats_t result;
+                bench_stats_compute(convergence, bench_config.reps, &result);
+                bench_report("stress", case_name, "ms", &result);
+                bench_stats_compute(messages, bench_config.reps, &result);
+                bench_report("stress", case_name, "vectors", &result);
+                bench_stats_compute(entries, bench_config.reps, &result);
+                bench_report("stress", case_name, "entries", &result);
+            }
+            topology_destroy(topology);
+        }
+    }
+    free(convergence);
+    free(messages);
+    free(entries);
+}
+
+// Runs the router stress test on Erdős–Rényi and hub-and-spoke topologies while sweeping the capacity of the
+// router channels, and reports the time to convergence and how often routers woke up for each
+void bench_stress_capacity()
+{
+    enum topology_family families[] = {TOPOLOGY_ERDOS_RENYI, TOPOLOGY_HUB};
+    size_t capacities[] = {1, 2, 4, 16, 64};
+    size_t num_nodes = bench_config.quick ? 32 : 256;
+    double* convergence = malloc(sizeof(double) * bench_config.reps);
+    double* wakeups = malloc(sizeof(double) * bench_config.reps);
+    assert(convergence != NULL && wakeups != NULL);
+
+    bench_report_header("stress_capacity");
+    for (size_t f = 0; f < sizeof(families) / sizeof(families[0]); f++) {
+        topology_t* topology = topology_generate(families[f], num_nodes, STRESS_LINKS_PER_NODE * num_nodes, 1, num_nodes);
+        struct {
+            const char* name;
+            size_t num_workers;
+        } modes[] = {{"threads", 0}, {"pool", bench_num_cpus()}};
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+            for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); c++) {
+                stress_stats_t stats;
+                for (size_t w = 0; w < bench_config.warmup; w++) {
+                    run_stress_topology(capacities[c], 1, topology, modes[m].num_workers, &stats);
+                }
+                for (size_t r = 0; r < bench_config.reps; r++) {
+                    run_stress_topology(capacities[c], 1, topology, modes[m].num_workers, &stats);
+                    convergence[r] = (double)stats.convergence_ns / 1e6;
+                    wakeups[r] = (double)stats.wakeups;
+                }
+                char case_name[128];
+                snprintf(case_name, sizeof(case_name), "%s n=%zu cap=%zu %s", topology_family_name(families[f]), num_nodes,
+                         capacities[c], modes[m].name);
+                bench_stats_t result;
+                bench_stats_compute(convergence, bench_config.reps, &result);
+                bench_report("stress_capacity", case_name, "ms", &result);
+                bench_stats_compute(wakeups, bench_config.reps, &result);
+                bench_report("stress_capacity", case_name, "wakeups", &result);
+            }
+        }
+        topology_destroy(topology);
+    }
+    free(convergence);
+    free(wakeups);
+}
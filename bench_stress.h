@@ -0,0 +1,13 @@
+#ifndef BENCH_STRESS_H
+#define BENCH_STRESS_H
+
+// Runs the router stress test on generated ring, grid, Erdős–Rényi, scale-free and hub-and-spoke topologies
+// with one thread per router and with routers multiplexed on a task pool, and reports the time to convergence,
+// the distance vector updates exchanged and the entries they carried for each
+void bench_stress();
+
+// Runs the router stress test on Erdős–Rényi and hub-and-spoke topologies while sweeping the capacity of the
+// router channels, and reports the time to convergence and how often routers woke up for each
+void bench_stress_capacity();
+
+#endif // BENCH_STRESS_H
@@ -0,0 +1,154 @@
+#include <pthread.h>
+#include <sched.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "channel.h"
+#include "bench_util.h"
+#include "bench_throughput.h"
+
+typedef struct {
+    channel_t* channel;
+    size_t count;
+    bool non_blocking;
+    pthread_barrier_t* start;
+    uint64_t start_ns;
+    uint64_t end_ns;
+} throughput_args_t;
+
+static void* producer(void* arg)
+{
+    throughput_args_t* args = arg;
+    pthread_barrier_wait(args->start);
+    args->start_ns = bench_now_ns();
+    for (size_t i = 1; i <= args->count; i++) {
+        enum channel_status status;
+        if (args->non_blocking) {
+            while ((status = channel_non_blocking_send(args->channel, (void*)i)) == CHANNEL_FULL) {
+                sched_yield();
+            }
+        } else {
+            status = channel_send(args->channel, (void*)i);
+        }
+        assert(status == SUCCESS);
+    }
+    args->end_ns = bench_now_ns();
+    return NULL;
+}
+
+static void* consumer(void* arg)
+{
+    throughput_args_t* args = arg;
+    pthread_barrier_wait(args->start);
+    args->start_ns = bench_now_ns();
+    for (size_t i = 0; i < args->count; i++) {
+        void* data = NULL;
+        enum channel_status status;
+        if (args->non_blocking) {
+            while ((status = channel_non_blocking_receive(args->channel, &data)) == CHANNEL_EMPTY) {
+                sched_yield();
+            }
+        } else {
+            status = channel_receive(args->channel, &data);
+        }
+        assert(status == SUCCESS);
+        assert(data != NULL);
+    }
+    args->end_ns = bench_now_ns();
+    return NULL;
+}
+
+// Moves total messages from num_producers to num_consumers through one channel
+// Returns the achieved rate in messages/sec
+static double run_once(size_t capacity, size_t num_producers, size_t num_consumers, size_t total, bool non_blocking)
+{
+    channel_t* channel = channel_create(capacity);
+    assert(channel != NULL);
+    size_t num_threads = num_producers + num_consumers;
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, (unsigned)num_threads);
+    pthread_t* pid = malloc(sizeof(pthread_t) * num_threads);
+    throughput_args_t* args = malloc(sizeof(throughput_args_t) * num_threads);
+    assert(pid != NULL && args != NULL);
+    for (size_t i = 0; i < num_threads; i++) {
+        bool is_producer = i < num_producers;
+        args[i].channel = channel;
+        args[i].count = is_producer ? total / num_producers : total / num_consumers;
+        args[i].non_blocking = non_blocking;
+        args[i].start = &start;
+        int pthread_status = pthread_create(&pid[i], NULL, is_producer ? producer : consumer, &args[i]);
+        assert(pthread_status == 0);
+    }
+    // the run spans from the first thread leaving the barrier to the last thread finishing
+    uint64_t first_start = UINT64_MAX;
+    uint64_t last_end = 0;
+    for (size_t i = 0; i < num_threads; i++) {
+        pthread_join(pid[i], NULL);
+        if (args[i].start_ns < first_start) {
+            first_start = args[i].start_ns;
+        }
+        if (args[i].end_ns > last_end) {
+            last_end = args[i].end_ns;
+        }
+    }
+    uint64_t t = last_end - first_start;
+    pthread_barrier_destroy(&start);
+    channel_close(channel);
+    channel_destroy(channel);
+    free(args);
+    free(pid);
+    return (double)total * 1e9 / (double)t;
+}
+
+static void run_case(const char* pattern, size_t capacity, size_t num_producers, size_t num_consumers, bool non_blocking)
+{
+    // every producer and every consumer handles an equal share
+    size_t unit = num_producers * num_consumers;
+    size_t total = (bench_config.messages / unit) * unit;
+    if (total == 0) {
+        total = unit;
+    }
+    for (size_t i = 0; i < bench_config.warmup; i++) {
+        run_once(capacity, num_producers, num_consumers, total, non_blocking);
+    }
+    double* samples = malloc(sizeof(double) * bench_config.reps);
+    assert(samples != NULL);
+    for (size_t i = 0; i < bench_config.reps; i++) {
+        samples[i] = run_once(capacity, num_producers, num_consumers, total, non_blocking);
+    }
+    bench_stats_t stats;
+    bench_stats_compute(samples, bench_config.reps, &stats);
+    free(samples);
+
+    char case_name[128];
+    snprintf(case_name, sizeof(case_name), "%s %s p=%zu c=%zu cap=%zu", pattern, non_blocking ? "nb" : "blk", num_producers, num_consumers, capacity);
+    bench_report("throughput", case_name, "msg/s", &stats);
+}
+
+// Measures messages/sec for SPSC, MPSC, SPMC and MPMC over blocking and non-blocking send/receive,
+// sweeping channel capacity and thread counts
+void bench_throughput()
+{
+    static const size_t capacities[] = {1, 16, 256, 4096, 65536};
+    static const size_t quick_capacities[] = {1, 256, 65536};
+    static const size_t thread_counts[] = {2, 4, 8};
+    static const size_t quick_thread_counts[] = {4};
+
+    const size_t* caps = bench_config.quick ? quick_capacities : capacities;
+    size_t num_caps = bench_config.quick ? sizeof(quick_capacities) / sizeof(size_t) : sizeof(capacities) / sizeof(size_t);
+    const size_t* threads = bench_config.quick ? quick_thread_counts : thread_counts;
+    size_t num_threads = bench_config.quick ? sizeof(quick_thread_counts) / sizeof(size_t) : sizeof(thread_counts) / sizeof(size_t);
+
+    bench_report_header("throughput");
+    for (int mode = 0; mode < 2; mode++) {
+        bool non_blocking = mode == 1;
+        for (size_t c = 0; c < num_caps; c++) {
+            run_case("spsc", caps[c], 1, 1, non_blocking);
+            for (size_t t = 0; t < num_threads; t++) {
+                run_case("mpsc", caps[c], threads[t], 1, non_blocking);
+                run_case("spmc", caps[c], 1, threads[t], non_blocking);
+                run_case("mpmc", caps[c], threads[t], threads[t], non_blocking);
+            }
+        }
+    }
+}
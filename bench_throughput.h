@@ -0,0 +1,8 @@
+#ifndef BENCH_THROUGHPUT_H
+#define BENCH_THROUGHPUT_H
+
+// Measures messages/sec for SPSC, MPSC, SPMC and MPMC over blocking and non-blocking send/receive,
+// sweeping channel capacity and thread counts
+void bench_throughput();
+
+#endif // BENCH_THROUGHPUT_H
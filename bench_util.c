@@ -0,0 +1,350 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "bench_util.h"
+
+#define NS_PER_SEC 1000000000ull
+
+// Returns the current monotonic time in nanoseconds
+uint64_t bench_now_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * NS_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+// Returns a raw timestamp from the cheapest clock available (the TSC on x86)
+// Convert differences to nanoseconds with bench_ticks_to_ns
+uint64_t bench_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return bench_now_ns();
+#endif
+}
+
+static double ticks_per_ns;
+static pthread_once_t ticks_once = PTHREAD_ONCE_INIT;
+
+static void calibrate_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // spin for 50ms and compare the two clocks; long enough that the read overhead is noise
+    uint64_t t0 = bench_now_ns();
+    uint64_t c0 = bench_ticks();
+    uint64_t t1;
+    do {
+        t1 = bench_now_ns();
+    } while (t1 - t0 < 50000000ull);
+    uint64_t c1 = bench_ticks();
+    ticks_per_ns = (double)(c1 - c0) / (double)(t1 - t0);
+#else
+    ticks_per_ns = 1.0;
+#endif
+}
+
+// Converts a tick difference from bench_ticks to nanoseconds
+// The first call calibrates the tick rate against CLOCK_MONOTONIC
+uint64_t bench_ticks_to_ns(uint64_t ticks)
+{
+    pthread_once(&ticks_once, calibrate_ticks);
+    return (uint64_t)((double)ticks / ticks_per_ns);
+}
+
+// Returns the number of online CPUs
+size_t bench_num_cpus()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+}
+
+// Pins the calling thread to the given CPU, taken modulo the number of online CPUs
+// Returns false if the affinity could not be set
+bool bench_pin_self(size_t cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % bench_num_cpus(), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// Lets the calling thread run on any online CPU again
+void bench_unpin_self()
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t cpu = 0; cpu < bench_num_cpus(); cpu++) {
+        CPU_SET(cpu, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// Takes a process-wide snapshot of CPU time and context switches
+void bench_usage_process(bench_usage_t* usage)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    usage->cpu_ns = ((uint64_t)ru.ru_utime.tv_sec + (uint64_t)ru.ru_stime.tv_sec) * NS_PER_SEC
+                  + ((uint64_t)ru.ru_utime.tv_usec + (uint64_t)ru.ru_stime.tv_usec) * 1000u;
+    usage->voluntary = (uint64_t)ru.ru_nvcsw;
+    usage->involuntary = (uint64_t)ru.ru_nivcsw;
+}
+
+// Takes a snapshot of the calling thread's own CPU time and context switches
+void bench_usage_thread(bench_usage_t* usage)
+{
+    struct timespec cpu;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+    usage->cpu_ns = (uint64_t)cpu.tv_sec * NS_PER_SEC + (uint64_t)cpu.tv_nsec;
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    usage->voluntary = (uint64_t)ru.ru_nvcsw;
+    usage->involuntary = (uint64_t)ru.ru_nivcsw;
+}
+
+static size_t hist_index(uint64_t value)
+{
+    if (value < BENCH_HIST_SUB_COUNT) {
+        return (size_t)value;
+    }
+    // the position of the top bit selects the group, the next BENCH_HIST_SUB_BITS bits the sub-bucket
+    unsigned top = 63u - (unsigned)__builtin_clzll(value);
+    unsigned shift = top - BENCH_HIST_SUB_BITS;
+    size_t group = (size_t)(shift + 1);
+    size_t sub = (size_t)((value >> shift) - BENCH_HIST_SUB_COUNT);
+    return group * BENCH_HIST_SUB_COUNT + sub;
+}
+
+static uint64_t hist_value(size_t index)
+{
+    if (index < BENCH_HIST_SUB_COUNT) {
+        return index;
+    }
+    size_t group = index / BENCH_HIST_SUB_COUNT;
+    size_t sub = index % BENCH_HIST_SUB_COUNT;
+    unsigned shift = (unsigned)(group - 1);
+    // report the upper edge of the bucket so percentiles never understate latency
+    return ((uint64_t)(sub + BENCH_HIST_SUB_COUNT + 1) << shift) - 1;
+}
+
+// Resets a histogram to hold no values
+void bench_hist_reset(bench_hist_t* hist)
+{
+    memset(hist->counts, 0, sizeof(hist->counts));
+    hist->total = 0;
+    hist->min = UINT64_MAX;
+    hist->max = 0;
+}
+
+// Records one value in nanoseconds
+void bench_hist_record(bench_hist_t* hist, uint64_t value_ns)
+{
+    hist->counts[hist_index(value_ns)]++;
+    hist->total++;
+    if (value_ns < hist->min) {
+        hist->min = value_ns;
+    }
+    if (value_ns > hist->max) {
+        hist->max = value_ns;
+    }
+}
+
+// Adds every value recorded in src to dst
+void bench_hist_merge(bench_hist_t* dst, const bench_hist_t* src)
+{
+    for (size_t i = 0; i < BENCH_HIST_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    if (src->min < dst->min) {
+        dst->min = src->min;
+    }
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+// Returns the smallest recorded value such that the given percentile (0 to 100) of values are at or below it
+uint64_t bench_hist_percentile(const bench_hist_t* hist, double percentile)
+{
+    if (hist->total == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)hist->total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BENCH_HIST_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            uint64_t value = hist_value(i);
+            return value < hist->max ? value : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Computes median, mean, sample standard deviation, min and max over the given samples
+// The samples array is sorted in place
+void bench_stats_compute(double* samples, size_t count, bench_stats_t* stats)
+{
+    if (count == 0) {
+        stats->median = stats->mean = stats->stddev = stats->min = stats->max = 0.0;
+        return;
+    }
+    qsort(samples, count, sizeof(double), compare_double);
+    stats->min = samples[0];
+    stats->max = samples[count - 1];
+    if (count % 2 == 1) {
+        stats->median = samples[count / 2];
+    } else {
+        stats->median = (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    stats->mean = sum / (double)count;
+    double sq = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        sq += (samples[i] - stats->mean) * (samples[i] - stats->mean);
+    }
+    stats->stddev = (count > 1) ? sqrt(sq / (double)(count - 1)) : 0.0;
+}
+
+static bool report_started;
+
+// Returns the stream results are written to
+FILE* bench_report_file()
+{
+    return bench_config.out != NULL ? bench_config.out : stdout;
+}
+
+static void write_json_string(FILE* out, const char* str)
+{
+    fputc('"', out);
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            fputc('\\', out);
+        }
+        fputc(*str, out);
+    }
+    fputc('"', out);
+}
+
+// Writes a set of named values for one case in the configured CSV or JSON format
+// Does nothing in text format; text callers print their own tables
+void bench_report_values(const char* bench, const char* case_name, const char* unit, const char* const* names, const double* values, size_t count)
+{
+    FILE* out = bench_report_file();
+    if (bench_config.format == BENCH_CSV) {
+        if (!report_started) {
+            fprintf(out, "bench,case,unit,metric,value\n");
+            report_started = true;
+        }
+        for (size_t i = 0; i < count; i++) {
+            fprintf(out, "%s,%s,%s,%s,%.6g\n", bench, case_name, unit, names[i], values[i]);
+        }
+    } else if (bench_config.format == BENCH_JSON) {
+        fputs(report_started ? ",\n  {" : "[\n  {", out);
+        report_started = true;
+        fputs("\"bench\": ", out);
+        write_json_string(out, bench);
+        fputs(", \"case\": ", out);
+        write_json_string(out, case_name);
+        fputs(", \"unit\": ", out);
+        write_json_string(out, unit);
+        for (size_t i = 0; i < count; i++) {
+            fputs(", ", out);
+            write_json_string(out, names[i]);
+            fprintf(out, ": %.17g", values[i]);
+        }
+        fputs("}", out);
+    }
+    fflush(out);
+}
+
+// Terminates the results document; call once after the last benchmark
+void bench_report_finish()
+{
+    FILE* out = bench_report_file();
+    if (bench_config.format == BENCH_CSV && !report_started) {
+        // an empty CSV still gets its header so consumers can parse it
+        fprintf(out, "bench,case,unit,metric,value\n");
+    }
+    if (bench_config.format == BENCH_JSON) {
+        fputs(report_started ? "\n]\n" : "[]\n", out);
+    }
+    fflush(out);
+}
+
+// Prints the column header for the result table of the given benchmark
+void bench_report_header(const char* bench)
+{
+    if (bench_config.format != BENCH_TEXT) {
+        return;
+    }
+    fprintf(bench_report_file(), "\n== %s ==\n", bench);
+    fprintf(bench_report_file(), "%-40s %-10s %14s %14s %14s %14s\n", "case", "unit", "median", "stddev", "min", "max");
+}
+
+// Prints one result row: the benchmark name, the case being measured, the unit and its statistics
+void bench_report(const char* bench, const char* case_name, const char* unit, const bench_stats_t* stats)
+{
+    if (bench_config.format != BENCH_TEXT) {
+        static const char* const names[] = {"median", "mean", "stddev", "min", "max"};
+        double values[] = {stats->median, stats->mean, stats->stddev, stats->min, stats->max};
+        bench_report_values(bench, case_name, unit, names, values, 5);
+        return;
+    }
+    fprintf(bench_report_file(), "%-40s %-10s %14.1f %14.1f %14.1f %14.1f\n", case_name, unit, stats->median, stats->stddev, stats->min, stats->max);
+    fflush(bench_report_file());
+}
+
+// Prints the column header for a latency percentile table of the given benchmark
+void bench_report_latency_header(const char* bench)
+{
+    if (bench_config.format != BENCH_TEXT) {
+        return;
+    }
+    fprintf(bench_report_file(), "\n== %s ==\n", bench);
+    fprintf(bench_report_file(), "%-40s %10s %10s %10s %10s %10s %10s\n", "case", "count", "min ns", "p50 ns", "p99 ns", "p999 ns", "max ns");
+}
+
+// Prints one latency row: the case being measured and min/p50/p99/p999/max of the histogram in nanoseconds
+void bench_report_latency(const char* bench, const char* case_name, const bench_hist_t* hist)
+{
+    uint64_t min = hist->total ? hist->min : 0;
+    uint64_t p50 = bench_hist_percentile(hist, 50.0);
+    uint64_t p99 = bench_hist_percentile(hist, 99.0);
+    uint64_t p999 = bench_hist_percentile(hist, 99.9);
+    if (bench_config.format != BENCH_TEXT) {
+        static const char* const names[] = {"count", "min", "p50", "p99", "p999", "max"};
+        double values[] = {(double)hist->total, (double)min, (double)p50, (double)p99, (double)p999, (double)hist->max};
+        bench_report_values(bench, case_name, "ns", names, values, 6);
+        return;
+    }
+    fprintf(bench_report_file(), "%-40s %10llu %10llu %10llu %10llu %10llu %10llu\n", case_name,
+           (unsigned long long)hist->total, (unsigned long long)min, (unsigned long long)p50,
+           (unsigned long long)p99, (unsigned long long)p999, (unsigned long long)hist->max);
+    fflush(bench_report_file());
+}
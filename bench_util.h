@@ -0,0 +1,135 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Defines how results are written
+enum bench_format {
+    // Human-readable tables on stdout
+    BENCH_TEXT,
+    // One row per value: bench,case,unit,metric,value
+    BENCH_CSV,
+    // One array of objects, one object per reported case
+    BENCH_JSON
+};
+
+// Defines the run parameters shared by every benchmark
+typedef struct {
+    // Number of untimed repetitions run before measuring
+    size_t warmup;
+    // Number of timed repetitions used to compute the statistics
+    size_t reps;
+    // Number of messages moved through the channel in each repetition
+    size_t messages;
+    // Shrinks every sweep to a handful of points for smoke runs
+    bool quick;
+    // Number of channels chained together by the open-loop pipeline
+    size_t pipeline_depth;
+    // Output format of the results
+    enum bench_format format;
+    // Destination of the results; stdout when NULL
+    FILE* out;
+} bench_config_t;
+
+// Defines summary statistics over a set of repetition samples
+typedef struct {
+    double median;
+    double mean;
+    double stddev;
+    double min;
+    double max;
+} bench_stats_t;
+
+// Defines a log-linear latency histogram in nanoseconds
+// Values below 2^BENCH_HIST_SUB_BITS are recorded exactly, larger values keep BENCH_HIST_SUB_BITS bits of precision
+#define BENCH_HIST_SUB_BITS 7
+#define BENCH_HIST_SUB_COUNT (1u << BENCH_HIST_SUB_BITS)
+#define BENCH_HIST_BUCKETS ((64 - BENCH_HIST_SUB_BITS + 1) * BENCH_HIST_SUB_COUNT)
+typedef struct {
+    uint64_t counts[BENCH_HIST_BUCKETS];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+} bench_hist_t;
+
+// Defines a snapshot of CPU time and context switch counters
+typedef struct {
+    // User plus system CPU time in nanoseconds
+    uint64_t cpu_ns;
+    // Context switches where the thread blocked, i.e. the number of times it had to be woken
+    uint64_t voluntary;
+    // Context switches where the thread was preempted
+    uint64_t involuntary;
+} bench_usage_t;
+
+extern bench_config_t bench_config;
+
+// Returns the current monotonic time in nanoseconds
+uint64_t bench_now_ns();
+
+// Returns a raw timestamp from the cheapest clock available (the TSC on x86)
+// Convert differences to nanoseconds with bench_ticks_to_ns
+uint64_t bench_ticks();
+
+// Converts a tick difference from bench_ticks to nanoseconds
+// The first call calibrates the tick rate against CLOCK_MONOTONIC
+uint64_t bench_ticks_to_ns(uint64_t ticks);
+
+// Returns the number of online CPUs
+size_t bench_num_cpus();
+
+// Pins the calling thread to the given CPU, taken modulo the number of online CPUs
+// Returns false if the affinity could not be set
+bool bench_pin_self(size_t cpu);
+
+// Lets the calling thread run on any online CPU again
+void bench_unpin_self();
+
+// Takes a process-wide snapshot of CPU time and context switches
+void bench_usage_process(bench_usage_t* usage);
+
+// Takes a snapshot of the calling thread's own CPU time and context switches
+void bench_usage_thread(bench_usage_t* usage);
+
+// Resets a histogram to hold no values
+void bench_hist_reset(bench_hist_t* hist);
+
+// Records one value in nanoseconds
+void bench_hist_record(bench_hist_t* hist, uint64_t value_ns);
+
+// Adds every value recorded in src to dst
+void bench_hist_merge(bench_hist_t* dst, const bench_hist_t* src);
+
+// Returns the smallest recorded value such that the given percentile (0 to 100) of values are at or below it
+uint64_t bench_hist_percentile(const bench_hist_t* hist, double percentile);
+
+// Computes median, mean, sample standard deviation, min and max over the given samples
+// The samples array is sorted in place
+void bench_stats_compute(double* samples, size_t count, bench_stats_t* stats);
+
+// Returns the stream results are written to
+FILE* bench_report_file();
+
+// Writes a set of named values for one case in the configured CSV or JSON format
+// Does nothing in text format; text callers print their own tables
+void bench_report_values(const char* bench, const char* case_name, const char* unit, const char* const* names, const double* values, size_t count);
+
+// Terminates the results document; call once after the last benchmark
+void bench_report_finish();
+
+// Prints the column header for the result table of the given benchmark
+void bench_report_header(const char* bench);
+
+// Prints one result row: the benchmark name, the case being measured, the unit and its statistics
+void bench_report(const char* bench, const char* case_name, const char* unit, const bench_stats_t* stats);
+
+// Prints the column header for a latency percentile table of the given benchmark
+void bench_report_latency_header(const char* bench);
+
+// Prints one latency row: the case being measured and min/p50/p99/p999/max of the histogram in nanoseconds
+void bench_report_latency(const char* bench, const char* case_name, const bench_hist_t* hist);
+
+#endif // BENCH_UTIL_H
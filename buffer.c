@@ -3,8 +3,22 @@
 // Creates a buffer with the given capacity
 buffer_t* buffer_create(size_t capacity)
 {
-    buffer_t* buffer = (buffer_t*) malloc(sizeof(buffer_t));
-    void** data  = (void**) malloc(capacity * sizeof(void*));
+    return buffer_create_with_allocator(capacity, NULL);
+}
+
+// Creates a buffer with the given capacity whose memory comes from the given allocator
+// A NULL allocator uses malloc; returns NULL if the allocator runs out of memory
+buffer_t* buffer_create_with_allocator(size_t capacity, const allocator_t* allocator)
+{
+    buffer_t* buffer = (buffer_t*) allocator_alloc(allocator, sizeof(buffer_t));
+    if (buffer == NULL) {
+        return NULL;
+    }
+    void** data = (void**) allocator_alloc(allocator, capacity * sizeof(void*));
+    if (data == NULL && capacity > 0) {
+        allocator_free(allocator, buffer, sizeof(buffer_t));
+        return NULL;
+    }
     buffer->size = 0;
     buffer->next = 0;
     buffer->capacity = capacity;
@@ -49,8 +63,14 @@ enum buffer_status buffer_remove(buffer_t* buffer, void **data)
 // Frees the memory allocated to the buffer
 void buffer_free(buffer_t *buffer)
 {
-    free(buffer->data);
-    free(buffer);
+    buffer_destroy_with_allocator(buffer, NULL);
+}
+
+// Frees a buffer created by buffer_create_with_allocator back to the same allocator
+void buffer_destroy_with_allocator(buffer_t* buffer, const allocator_t* allocator)
+{
+    allocator_free(allocator, buffer->data, buffer->capacity * sizeof(void*));
+    allocator_free(allocator, buffer, sizeof(buffer_t));
 }
 
 // Returns the total capacity of the buffer
@@ -2,6 +2,7 @@
 #define BUFFER_H
 
 #include <stdlib.h>
+#include "allocator.h"
 
 typedef struct {
     size_t size;
@@ -18,6 +19,10 @@ enum buffer_status {
 // Creates a buffer with the given capacity
 buffer_t* buffer_create(size_t capacity);
 
+// Creates a buffer with the given capacity whose memory comes from the given allocator
+// A NULL allocator uses malloc; returns NULL if the allocator runs out of memory
+buffer_t* buffer_create_with_allocator(size_t capacity, const allocator_t* allocator);
+
 // Adds the value into the buffer
 // Returns BUFFER_SUCCESS if the buffer is not full and value was added
 // Returns BUFFER_ERROR otherwise
@@ -31,6 +36,9 @@ enum buffer_status buffer_remove(buffer_t* buffer, void** data);
 // Frees the memory allocated to the buffer
 void buffer_free(buffer_t* buffer);
 
+// Frees a buffer created by buffer_create_with_allocator back to the same allocator
+void buffer_destroy_with_allocator(buffer_t* buffer, const allocator_t* allocator);
+
 // Returns the total capacity of the buffer
 size_t buffer_capacity(buffer_t* buffer);
 
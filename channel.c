@@ -1,15 +1,44 @@
 #include "channel.h"
 
+// Calls a channel_watch_t callback; used with list_foreach on the channel's watch list
+static void notify_watch(void* data) {
+    channel_watch_t* watch = (channel_watch_t*)data;
+    watch->notify(watch->arg);
+}
+
 // Creates a new channel with the provided size and returns it to the caller
 // A 0 size indicates an unbuffered channel, whereas a positive size indicates a buffered channel
 channel_t* channel_create(size_t size) {
-    channel_t* chan = (channel_t*)malloc(sizeof(channel_t));
-    chan->buffer = buffer_create(size);
+    return channel_create_with_allocator(size, NULL);
+}
+
+// Same as channel_create, except that the channel, its buffer and the list nodes used by blocked selects and
+// watches are allocated from the given allocator instead of malloc
+// A NULL allocator behaves as channel_create; the allocator's context must outlive the channel
+// Returns NULL, with everything already allocated given back, if the allocator runs out of memory
+channel_t* channel_create_with_allocator(size_t size, const channel_allocator_t* allocator) {
+    channel_t* chan = (channel_t*)allocator_alloc(allocator, sizeof(channel_t));
+    if (chan == NULL) {
+        return NULL;
+    }
+    chan->allocator = allocator != NULL ? *allocator : (allocator_t){NULL, NULL, NULL};
+    chan->buffer = buffer_create_with_allocator(size, &chan->allocator);
+    chan->select = chan->buffer != NULL ? list_create_with_allocator(&chan->allocator) : NULL;
+    chan->watch = chan->select != NULL ? list_create_with_allocator(&chan->allocator) : NULL;
+    if (chan->watch == NULL) {
+        if (chan->select != NULL) {
+            list_destroy(chan->select);
+        }
+        if (chan->buffer != NULL) {
+            buffer_destroy_with_allocator(chan->buffer, &chan->allocator);
+        }
+        allocator_free(allocator, chan, sizeof(channel_t));
+        return NULL;
+    }
     pthread_mutex_init(&chan->mutex, NULL);
     pthread_cond_init(&chan->recv, NULL);
     pthread_cond_init(&chan->send, NULL);
     chan->is_closed = false;
-    chan->select = list_create();
     return chan;
 }
 
@@ -36,6 +65,7 @@ enum channel_status channel_send(channel_t *channel, void* data) {
         pthread_cond_signal(&channel->send);
         if (channel->select)
             list_foreach(channel->select, (void*)sem_post);
+        list_foreach(channel->watch, notify_watch);
         pthread_mutex_unlock(&channel->mutex);
         return SUCCESS;
     }
@@ -68,6 +98,7 @@ enum channel_status channel_receive(channel_t* channel, void** data) {
         pthread_cond_signal(&channel->recv);
         if (channel->select)
             list_foreach(channel->select, (void*)sem_post);
+        list_foreach(channel->watch, notify_watch);
         pthread_mutex_unlock(&channel->mutex);
         return SUCCESS;
     }
@@ -98,6 +129,7 @@ enum channel_status channel_non_blocking_send(channel_t* channel, void* data) {
         pthread_cond_signal(&channel->send);
         if (channel->select)
             list_foreach(channel->select, (void*)sem_post);
+        list_foreach(channel->watch, notify_watch);
         pthread_mutex_unlock(&channel->mutex);
         return SUCCESS;
     }
@@ -128,6 +160,7 @@ enum channel_status channel_non_blocking_receive(channel_t* channel, void** data
         pthread_cond_signal(&channel->recv);
         if (channel->select)
             list_foreach(channel->select, (void*)sem_post);
+        list_foreach(channel->watch, notify_watch);
         pthread_mutex_unlock(&channel->mutex);
         return SUCCESS;
     }
@@ -154,6 +187,7 @@ enum channel_status channel_close(channel_t* channel) {
         pthread_cond_broadcast(&channel->recv);
         if (channel->select)
             list_foreach(channel->select, (void*)sem_post);
+        list_foreach(channel->watch, notify_watch);
         pthread_mutex_unlock(&channel->mutex);
         return SUCCESS;
     }
@@ -175,12 +209,14 @@ enum channel_status channel_destroy(channel_t* channel) {
         return DESTROY_ERROR;
     }
     else if (channel->is_closed) {
-        buffer_free(channel->buffer);
+        allocator_t allocator = channel->allocator;
+        buffer_destroy_with_allocator(channel->buffer, &allocator);
         pthread_mutex_destroy(&channel->mutex);
         pthread_cond_destroy(&channel->recv);
         pthread_cond_destroy(&channel->send);
         list_destroy(channel->select);
-        free(channel);
+        list_destroy(channel->watch);
+        allocator_free(&allocator, channel, sizeof(channel_t));
         return SUCCESS;
     }
     else {
@@ -196,20 +232,29 @@ enum channel_status channel_destroy(channel_t* channel) {
 // Once an operation has been successfully performed, select should set selected_index to the index of the channel that performed the operation and then return SUCCESS
 // In the event that a channel is closed or encounters any error, the error should be propagated and returned through select
 // Additionally, selected_index is set to the index of the channel that generated the error
+// GEN_ERROR is returned if a channel's allocator runs out while registering the blocked select with it
 enum channel_status channel_select(select_t* channel_list, size_t channel_count, size_t* selected_index) {
     sem_t select;
     sem_init(&select, 0, 0);
 
     for (int i=0; i<channel_count; i++) {
         pthread_mutex_lock(&channel_list[i].channel->mutex);
-        if (channel_list[i].channel->is_closed) {
-            pthread_mutex_unlock(&channel_list[i].channel->mutex);
+        enum channel_status status = SUCCESS;
+        if (channel_list[i].channel->is_closed)
+            status = CLOSED_ERROR;
+        else if (list_insert(channel_list[i].channel->select, &select) != LIST_SUCCESS)
+            status = GEN_ERROR; // the channel's allocator ran out
+        pthread_mutex_unlock(&channel_list[i].channel->mutex);
+        if (status != SUCCESS) {
+            for (int j=0; j<i; j++) {
+                pthread_mutex_lock(&channel_list[j].channel->mutex);
+                list_remove(channel_list[j].channel->select, list_find(channel_list[j].channel->select, &select));
+                pthread_mutex_unlock(&channel_list[j].channel->mutex);
+            }
+            *selected_index = (size_t) i;
             sem_destroy(&select);
-            return CLOSED_ERROR;
+            return status;
         }
-        else
-            list_insert(channel_list[i].channel->select, &select);
-        pthread_mutex_unlock(&channel_list[i].channel->mutex);
     }
     
     while (true) {
@@ -219,7 +264,7 @@ enum channel_status channel_select(select_t* channel_list, size_t channel_count,
             if (channel_list[i].dir == SEND)
                 status = channel_non_blocking_send(channel_list[i].channel, channel_list[i].data);
             else if (channel_list[i].dir == RECV)
-                status = channel_non_blocking_receive(channel_list[i].channel, channel_list[i].data);
+                status = channel_non_blocking_receive(channel_list[i].channel, &channel_list[i].data);
             if (status==SUCCESS || status==GEN_ERROR || status==DESTROY_ERROR || status==CLOSED_ERROR) {
                 for (int j=0; j<channel_count; j++) {
                     pthread_mutex_lock(&channel_list[j].channel->mutex);
@@ -233,4 +278,53 @@ enum channel_status channel_select(select_t* channel_list, size_t channel_count,
         }
         sem_wait(&select);
     }
-}
\ No newline at end of file
+}
+
+// Same as channel_select, except that it simply returns if no channel can perform its operation
+// Returns CHANNEL_EMPTY (with selected_index untouched) when no operation is possible, and otherwise
+// returns and sets selected_index as channel_select does
+enum channel_status channel_non_blocking_select(select_t* channel_list, size_t channel_count, size_t* selected_index) {
+    for (size_t i = 0; i < channel_count; i++) {
+        enum channel_status status = GEN_ERROR;
+        if (channel_list[i].dir == SEND)
+            status = channel_non_blocking_send(channel_list[i].channel, channel_list[i].data);
+        else if (channel_list[i].dir == RECV)
+            status = channel_non_blocking_receive(channel_list[i].channel, &channel_list[i].data);
+        if (status != CHANNEL_EMPTY) {
+            *selected_index = i;
+            return status;
+        }
+    }
+    return CHANNEL_EMPTY;
+}
+
+// Registers a callback that is notified on every change to the channel until channel_unwatch is called
+// The same watch may be registered on several channels, but only once per channel
+// Returns SUCCESS if the watch is registered,
+// CLOSED_ERROR if the channel is closed, and
+// GEN_ERROR in any other error case, such as the channel's allocator running out
+enum channel_status channel_watch(channel_t* channel, channel_watch_t* watch) {
+    pthread_mutex_lock(&channel->mutex);
+    if (channel->is_closed) {
+        pthread_mutex_unlock(&channel->mutex);
+        return CLOSED_ERROR;
+    }
+    enum list_status status = list_insert(channel->watch, watch);
+    pthread_mutex_unlock(&channel->mutex);
+    return status == LIST_SUCCESS ? SUCCESS : GEN_ERROR;
+}
+
+// Removes a callback registered with channel_watch; once this returns, the callback is no longer running for this channel
+// Returns SUCCESS if the watch was registered and is now removed, and
+// GEN_ERROR in any other error case
+enum channel_status channel_unwatch(channel_t* channel, channel_watch_t* watch) {
+    pthread_mutex_lock(&channel->mutex);
+    list_node_t* node = list_find(channel->watch, watch);
+    if (node == NULL) {
+        pthread_mutex_unlock(&channel->mutex);
+        return GEN_ERROR;
+    }
+    list_remove(channel->watch, node);
+    pthread_mutex_unlock(&channel->mutex);
+    return SUCCESS;
+}
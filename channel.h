@@ -10,6 +10,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include "linked_list.h"
+#include "allocator.h"
 
 // Defines possible return values from channel functions
 enum channel_status {
@@ -21,6 +22,14 @@ enum channel_status {
     DESTROY_ERROR = -3
 };
 
+// Defines a callback registration on a channel
+// notify is called with arg whenever a send, receive or close on the channel may have made an operation on it possible
+// It runs with the channel's lock held, so it must not operate on that channel; it should only schedule the waiter
+typedef struct {
+    void (*notify)(void* arg);
+    void* arg;
+} channel_watch_t;
+
 // Defines channel object
 typedef struct {
     // DO NOT REMOVE buffer (OR CHANGE ITS NAME) FROM THE STRUCT
@@ -33,8 +42,14 @@ typedef struct {
     pthread_cond_t send;
     bool is_closed;
     list_t* select;
+    list_t* watch;
+    // Where the channel, its buffer and its select/watch list nodes are allocated
+    allocator_t allocator;
 } channel_t;
 
+// Allocator hook for channel_create_with_allocator; see allocator.h
+typedef allocator_t channel_allocator_t;
+
 // Defines channel list structure for channel_select function
 enum direction {
     SEND,
@@ -54,6 +69,12 @@ typedef struct {
 // A 0 size indicates an unbuffered channel, whereas a positive size indicates a buffered channel
 channel_t* channel_create(size_t size);
 
+// Same as channel_create, except that the channel, its buffer and the list nodes used by blocked selects and
+// watches are allocated from the given allocator instead of malloc
+// A NULL allocator behaves as channel_create; the allocator's context must outlive the channel
+// Returns NULL, with everything already allocated given back, if the allocator runs out of memory
+channel_t* channel_create_with_allocator(size_t size, const channel_allocator_t* allocator);
+
 // Writes data to the given channel
 // This is a blocking call i.e., the function only returns on a successful completion of send
 // In case the channel is full, the function waits till the channel has space to write the new data
@@ -107,6 +128,24 @@ enum channel_status channel_destroy(channel_t* channel);
 // Once an operation has been successfully performed, select should set selected_index to the index of the channel that performed the operation and then return SUCCESS
 // In the event that a channel is closed or encounters any error, the error should be propagated and returned through select
 // Additionally, selected_index is set to the index of the channel that generated the error
+// GEN_ERROR is returned if a channel's allocator runs out while registering the blocked select with it
 enum channel_status channel_select(select_t* channel_list, size_t channel_count, size_t* selected_index);
 
+// Same as channel_select, except that it simply returns if no channel can perform its operation
+// Returns CHANNEL_EMPTY (with selected_index untouched) when no operation is possible, and otherwise
+// returns and sets selected_index as channel_select does
+enum channel_status channel_non_blocking_select(select_t* channel_list, size_t channel_count, size_t* selected_index);
+
+// Registers a callback that is notified on every change to the channel until channel_unwatch is called
+// The same watch may be registered on several channels, but only once per channel
+// Returns SUCCESS if the watch is registered,
+// CLOSED_ERROR if the channel is closed, and
+// GEN_ERROR in any other error case, such as the channel's allocator running out
+enum channel_status channel_watch(channel_t* channel, channel_watch_t* watch);
+
+// Removes a callback registered with channel_watch; once this returns, the callback is no longer running for this channel
+// Returns SUCCESS if the watch was registered and is now removed, and
+// GEN_ERROR in any other error case
+enum channel_status channel_unwatch(channel_t* channel, channel_watch_t* watch);
+
 #endif // CHANNEL_H
\ No newline at end of file
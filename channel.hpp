@@ -0,0 +1,573 @@
+#ifndef CHANNEL_HPP
+#define CHANNEL_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+extern "C" {
+#include "channel.h"
+}
+
+namespace chan {
+
+// Capacity argument of Channel selecting a capacity given at run time
+inline constexpr size_t dynamic_capacity = SIZE_MAX;
+
+// Returns a C allocator hook that allocates from the given memory resource, which must outlive every channel
+// created with it
+// Blocks come back with the size they were allocated with and the alignment of std::max_align_t, as
+// memory_resource::deallocate requires
+// An exhausted resource is reported to the C side as a NULL block rather than an exception unwinding through it
+inline channel_allocator_t resource_allocator(std::pmr::memory_resource* resource)
+{
+    channel_allocator_t allocator;
+    allocator.alloc = [](void* context, size_t size) -> void* {
+        try {
+            return static_cast<std::pmr::memory_resource*>(context)->allocate(size, alignof(std::max_align_t));
+        } catch (const std::bad_alloc&) {
+            return nullptr;
+        }
+    };
+    allocator.free = [](void* context, void* ptr, size_t size) {
+        static_cast<std::pmr::memory_resource*>(context)->deallocate(ptr, size, alignof(std::max_align_t));
+    };
+    allocator.context = resource;
+    return allocator;
+}
+
+// Storage for one message; the message is constructed in place and only ever moved out by the receiver
+template <typename T>
+struct Slot {
+    alignas(T) unsigned char storage[sizeof(T)];
+    // Whether storage holds a constructed T; only touched by the thread owning the slot
+    bool live = false;
+
+    T* get()
+    {
+        return std::launder(reinterpret_cast<T*>(storage));
+    }
+
+    template <typename... Args>
+    void construct(Args&&... args)
+    {
+        assert(!live);
+        ::new (static_cast<void*>(storage)) T(std::forward<Args>(args)...);
+        live = true;
+    }
+
+    void destroy()
+    {
+        assert(live);
+        get()->~T();
+        live = false;
+    }
+};
+
+// Slots kept inline in the channel object when the capacity is known at compile time
+template <typename T, size_t N>
+class SlotStorage {
+public:
+    SlotStorage(size_t capacity, std::pmr::memory_resource*)
+    {
+        assert(capacity == N);
+        (void)capacity;
+    }
+
+    Slot<T>* data()
+    {
+        return slots_.data();
+    }
+
+    size_t size() const
+    {
+        return N;
+    }
+
+private:
+    std::array<Slot<T>, N> slots_;
+};
+
+// Slots allocated once at construction from a memory resource when the capacity is given at run time
+template <typename T>
+class SlotStorage<T, dynamic_capacity> {
+public:
+    SlotStorage(size_t capacity, std::pmr::memory_resource* resource)
+        : slots_(std::pmr::polymorphic_allocator<Slot<T>>(resource).allocate(capacity)), size_(capacity),
+          resource_(resource)
+    {
+        std::uninitialized_default_construct_n(slots_, capacity);
+    }
+
+    SlotStorage(const SlotStorage&) = delete;
+    SlotStorage& operator=(const SlotStorage&) = delete;
+
+    ~SlotStorage()
+    {
+        std::destroy_n(slots_, size_);
+        std::pmr::polymorphic_allocator<Slot<T>>(resource_).deallocate(slots_, size_);
+    }
+
+    Slot<T>* data()
+    {
+        return slots_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    Slot<T>* slots_;
+    size_t size_;
+    std::pmr::memory_resource* resource_;
+};
+
+// Typed channel storing up to capacity messages of type T inline in a ring of aligned slots, so sending a message
+// never allocates and receiving it is a move
+// Two C channels carry slot pointers: queue holds filled slots in send order and free holds empty ones, so a
+// sender blocks on free exactly when the channel is full and its send to queue never blocks
+// Both are plain channel_t objects, so a Channel takes part in channel_select next to C channels through
+// select_send/select_recv and finish_send/finish_recv
+// Capacity must be at least 1; a message lives in a slot, so there is no unbuffered rendezvous mode
+// The slot ring (when the capacity is dynamic), both C channels and their select/watch list nodes come from a
+// std::pmr::memory_resource, by default std::pmr::get_default_resource(); after construction only blocked selects
+// and watches allocate, and they do so from threads using the channel, so a resource shared with other threads
+// must be a synchronized one; construction throws std::bad_alloc if the resource runs out, and a blocked select or
+// coroutine wait fails with GEN_ERROR
+template <typename T, size_t N = dynamic_capacity>
+class Channel {
+    static_assert(N > 0, "Channel needs a capacity of at least 1");
+    static_assert(std::is_move_constructible_v<T>, "Channel messages are moved out on receive");
+
+public:
+    // Creates a channel with capacity N whose memory comes from resource, which must outlive the channel
+    template <size_t M = N, std::enable_if_t<M != dynamic_capacity, int> = 0>
+    explicit Channel(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : Channel(N, resource, 0)
+    {
+    }
+
+    // Creates a channel with the given capacity whose memory comes from resource, which must outlive the channel
+    template <size_t M = N, std::enable_if_t<M == dynamic_capacity, int> = 0>
+    explicit Channel(size_t capacity, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : Channel(capacity, resource, 0)
+    {
+    }
+
+    // Channels hand out pointers into their own slots, so they never move
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    // Closes the channel if still open and destroys any messages never received
+    // The caller must have stopped every thread using the channel
+    ~Channel()
+    {
+        close();
+        enum channel_status status = channel_destroy(queue_);
+        assert(status == SUCCESS);
+        status = channel_destroy(free_);
+        assert(status == SUCCESS);
+        (void)status;
+        for (size_t i = 0; i < storage_.size(); i++) {
+            if (storage_.data()[i].live) {
+                storage_.data()[i].destroy();
+            }
+        }
+    }
+
+    size_t capacity() const
+    {
+        return storage_.size();
+    }
+
+    // Constructs a message from args directly in a free slot and sends it, waiting for a slot if the channel is full
+    // Returns SUCCESS, CLOSED_ERROR or GEN_ERROR as channel_send does
+    template <typename... Args>
+    enum channel_status emplace(Args&&... args)
+    {
+        void* slot = nullptr;
+        enum channel_status status = channel_receive(free_, &slot);
+        if (status != SUCCESS) {
+            return status;
+        }
+        return finish(slot, std::forward<Args>(args)...);
+    }
+
+    enum channel_status send(T&& value)
+    {
+        return emplace(std::move(value));
+    }
+
+    enum channel_status send(const T& value)
+    {
+        return emplace(value);
+    }
+
+    // Same as emplace, except that it returns CHANNEL_FULL instead of waiting when the channel is full
+    template <typename... Args>
+    enum channel_status try_emplace(Args&&... args)
+    {
+        void* slot = nullptr;
+        enum channel_status status = channel_non_blocking_receive(free_, &slot);
+        if (status != SUCCESS) {
+            return status == CHANNEL_EMPTY ? CHANNEL_FULL : status;
+        }
+        return finish(slot, std::forward<Args>(args)...);
+    }
+
+    enum channel_status try_send(T&& value)
+    {
+        return try_emplace(std::move(value));
+    }
+
+    enum channel_status try_send(const T& value)
+    {
+        return try_emplace(value);
+    }
+
+    // Moves the next message into out, waiting while the channel is empty
+    // Returns SUCCESS, CLOSED_ERROR or GEN_ERROR as channel_receive does; out is untouched unless SUCCESS
+    enum channel_status receive(T& out)
+    {
+        void* slot = nullptr;
+        enum channel_status status = channel_receive(queue_, &slot);
+        if (status == SUCCESS) {
+            out = take(slot);
+        }
+        return status;
+    }
+
+    // Returns the next message, waiting while the channel is empty, or nothing once the channel is closed
+    std::optional<T> receive()
+    {
+        void* slot = nullptr;
+        if (channel_receive(queue_, &slot) != SUCCESS) {
+            return std::nullopt;
+        }
+        return std::optional<T>(take(slot));
+    }
+
+    // Same as receive(out), except that it returns CHANNEL_EMPTY instead of waiting when the channel is empty
+    enum channel_status try_receive(T& out)
+    {
+        void* slot = nullptr;
+        enum channel_status status = channel_non_blocking_receive(queue_, &slot);
+        if (status == SUCCESS) {
+            out = take(slot);
+        }
+        return status;
+    }
+
+    // Closes the channel; blocked senders, receivers and selects return CLOSED_ERROR
+    // Returns SUCCESS, or CLOSED_ERROR if the channel was already closed
+    enum channel_status close()
+    {
+        enum channel_status status = channel_close(queue_);
+        channel_close(free_);
+        return status;
+    }
+
+    // Returns a select_t that channel_select can complete once a message can be sent without waiting
+    // When it is selected, pass it to finish_send along with the message
+    select_t select_send()
+    {
+        return select_t{free_, RECV, nullptr};
+    }
+
+    // Returns a select_t that channel_select can complete once a message is ready
+    // When it is selected, pass it to finish_recv to get the message
+    select_t select_recv()
+    {
+        return select_t{queue_, RECV, nullptr};
+    }
+
+    // Completes a send case chosen by channel_select by constructing the message from args
+    // Returns SUCCESS, or CLOSED_ERROR if the channel was closed since
+    template <typename... Args>
+    enum channel_status finish_send(const select_t& selected, Args&&... args)
+    {
+        assert(selected.channel == free_ && selected.data != nullptr);
+        return finish(selected.data, std::forward<Args>(args)...);
+    }
+
+    // Completes a receive case chosen by channel_select; returns the message
+    T finish_recv(const select_t& selected)
+    {
+        assert(selected.channel == queue_ && selected.data != nullptr);
+        return take(selected.data);
+    }
+
+private:
+    Channel(size_t capacity, std::pmr::memory_resource* resource, int) : storage_(capacity, resource)
+    {
+        assert(capacity > 0 && capacity != dynamic_capacity);
+        channel_allocator_t allocator = resource_allocator(resource);
+        queue_ = channel_create_with_allocator(capacity, &allocator);
+        if (queue_ == nullptr) {
+            throw std::bad_alloc();
+        }
+        free_ = channel_create_with_allocator(capacity, &allocator);
+        if (free_ == nullptr) {
+            channel_close(queue_);
+            channel_destroy(queue_);
+            throw std::bad_alloc();
+        }
+        for (size_t i = 0; i < capacity; i++) {
+            enum channel_status status = channel_non_blocking_send(free_, &storage_.data()[i]);
+            assert(status == SUCCESS);
+            (void)status;
+        }
+    }
+
+    // Builds the message in a slot taken from free and queues it
+    template <typename... Args>
+    enum channel_status finish(void* data, Args&&... args)
+    {
+        Slot<T>* slot = static_cast<Slot<T>*>(data);
+        try {
+            slot->construct(std::forward<Args>(args)...);
+        } catch (...) {
+            release(slot);
+            throw;
+        }
+        // the slot we hold is not in queue, so queue always has room for it
+        enum channel_status status = channel_non_blocking_send(queue_, slot);
+        if (status != SUCCESS) {
+            slot->destroy();
+            release(slot);
+        }
+        return status;
+    }
+
+    // Moves the message out of a slot received from queue and returns the slot to free
+    // If moving the message out throws, the message is lost but the slot still goes back to free
+    T take(void* data)
+    {
+        struct Guard {
+            Channel* channel;
+            Slot<T>* slot;
+
+            ~Guard()
+            {
+                slot->destroy();
+                channel->release(slot);
+            }
+        } guard{this, static_cast<Slot<T>*>(data)};
+        return T(std::move(*guard.slot->get()));
+    }
+
+    void release(Slot<T>* slot)
+    {
+        // free has room for every slot, so this only fails once the channel is closed
+        enum channel_status status = channel_non_blocking_send(free_, slot);
+        assert(status == SUCCESS || status == CLOSED_ERROR);
+        (void)status;
+    }
+
+    SlotStorage<T, N> storage_;
+    channel_t* queue_;
+    channel_t* free_;
+};
+
+namespace detail {
+
+// No-op handler for send cases given without one
+struct NoHandler {
+    void operator()() const {}
+};
+
+// Tags every select case type, so select only accepts cases built by on_recv and on_send
+struct SelectCase {};
+
+template <typename T, size_t N, typename F>
+struct RecvCase : SelectCase {
+    Channel<T, N>& channel;
+    F handler;
+
+    select_t entry() const
+    {
+        return channel.select_recv();
+    }
+
+    enum channel_status complete(const select_t& selected)
+    {
+        handler(channel.finish_recv(selected));
+        return SUCCESS;
+    }
+};
+
+template <typename T, size_t N, typename V, typename F>
+struct SendCase : SelectCase {
+    Channel<T, N>& channel;
+    V&& value;
+    F handler;
+
+    select_t entry() const
+    {
+        return channel.select_send();
+    }
+
+    enum channel_status complete(const select_t& selected)
+    {
+        enum channel_status status = channel.finish_send(selected, std::forward<V>(value));
+        if (status == SUCCESS) {
+            handler();
+        }
+        return status;
+    }
+};
+
+template <typename F>
+struct RawRecvCase : SelectCase {
+    channel_t* channel;
+    F handler;
+
+    select_t entry() const
+    {
+        return select_t{channel, RECV, nullptr};
+    }
+
+    enum channel_status complete(const select_t& selected)
+    {
+        handler(selected.data);
+        return SUCCESS;
+    }
+};
+
+template <typename F>
+struct RawSendCase : SelectCase {
+    channel_t* channel;
+    void* data;
+    F handler;
+
+    select_t entry() const
+    {
+        return select_t{channel, SEND, data};
+    }
+
+    enum channel_status complete(const select_t&)
+    {
+        handler();
+        return SUCCESS;
+    }
+};
+
+template <typename... Cases>
+inline constexpr bool are_select_cases = (std::is_base_of_v<SelectCase, std::remove_reference_t<Cases>> && ...);
+
+// Case table for one select: the select_t list handed to channel_select and, per case, the function finishing it,
+// all sized at compile time
+template <typename... Cases>
+class SelectTable {
+public:
+    static constexpr size_t size = sizeof...(Cases);
+
+    explicit SelectTable(Cases&... cases) : cases_(cases...), entries_{cases.entry()...} {}
+
+    select_t* entries()
+    {
+        return entries_.data();
+    }
+
+    // Finishes the case channel_select completed at index and runs its handler through a jump table
+    // Returns SUCCESS, or CLOSED_ERROR if a typed channel closed between the select and the send
+    enum channel_status complete(size_t index)
+    {
+        return complete(index, std::index_sequence_for<Cases...>());
+    }
+
+private:
+    template <size_t I>
+    static enum channel_status complete_case(SelectTable& table, size_t index)
+    {
+        return std::get<I>(table.cases_).complete(table.entries_[index]);
+    }
+
+    template <size_t... I>
+    enum channel_status complete(size_t index, std::index_sequence<I...>)
+    {
+        using complete_fn_t = enum channel_status (*)(SelectTable&, size_t);
+        static constexpr complete_fn_t jump_table[] = {&SelectTable::complete_case<I>...};
+        assert(index < size);
+        return jump_table[index](*this, index);
+    }
+
+    std::tuple<Cases&...> cases_;
+    std::array<select_t, sizeof...(Cases)> entries_;
+};
+
+} // namespace detail
+
+// Select case receiving a message from a typed channel and passing it to handler
+template <typename T, size_t N, typename F>
+detail::RecvCase<T, N, std::decay_t<F>> on_recv(Channel<T, N>& channel, F&& handler)
+{
+    return {{}, channel, std::forward<F>(handler)};
+}
+
+// Select case sending value on a typed channel, then calling handler with no arguments
+// The case refers to value, so build it in the select call itself
+template <typename T, size_t N, typename V, typename F = detail::NoHandler>
+detail::SendCase<T, N, V, std::decay_t<F>> on_send(Channel<T, N>& channel, V&& value, F&& handler = F())
+{
+    return {{}, channel, std::forward<V>(value), std::forward<F>(handler)};
+}
+
+// Select case receiving from a C channel and passing the void* message to handler
+template <typename F>
+detail::RawRecvCase<std::decay_t<F>> on_recv(channel_t* channel, F&& handler)
+{
+    return {{}, channel, std::forward<F>(handler)};
+}
+
+// Select case sending data on a C channel, then calling handler with no arguments
+template <typename F = detail::NoHandler>
+detail::RawSendCase<std::decay_t<F>> on_send(channel_t* channel, void* data, F&& handler = F())
+{
+    return {{}, channel, data, std::forward<F>(handler)};
+}
+
+// Typed channel_select over cases built with on_recv and on_send, for example
+// select(on_recv(requests, [](Request r) {...}), on_send(replies, reply, [] {...}))
+// Waits until a case can complete, completes it as channel_select would (the first ready case wins, so repeated
+// channels need no special handling) and runs its handler
+// Returns the status and the index of the case as channel_select does; no handler runs unless the status is SUCCESS
+template <typename... Cases, std::enable_if_t<detail::are_select_cases<Cases...>, int> = 0>
+std::pair<enum channel_status, size_t> select(Cases&&... cases)
+{
+    static_assert(sizeof...(Cases) > 0, "select needs at least one case");
+    detail::SelectTable<std::remove_reference_t<Cases>...> table(cases...);
+    size_t index = 0;
+    enum channel_status status = channel_select(table.entries(), table.size, &index);
+    if (status == SUCCESS) {
+        status = table.complete(index);
+    }
+    return {status, index};
+}
+
+// Same as select, except that it returns CHANNEL_EMPTY instead of waiting when no case can complete
+template <typename... Cases, std::enable_if_t<detail::are_select_cases<Cases...>, int> = 0>
+std::pair<enum channel_status, size_t> try_select(Cases&&... cases)
+{
+    static_assert(sizeof...(Cases) > 0, "select needs at least one case");
+    detail::SelectTable<std::remove_reference_t<Cases>...> table(cases...);
+    size_t index = 0;
+    enum channel_status status = channel_non_blocking_select(table.entries(), table.size, &index);
+    if (status == SUCCESS) {
+        status = table.complete(index);
+    }
+    return {status, index};
+}
+
+} // namespace chan
+
+#endif // CHANNEL_HPP
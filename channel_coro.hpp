@@ -0,0 +1,478 @@
+#ifndef CHANNEL_CORO_HPP
+#define CHANNEL_CORO_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include "channel.hpp"
+#include "task_pool.h"
+
+namespace chan {
+
+class Executor;
+
+namespace detail {
+
+// Operation a suspended coroutine is waiting on
+// Its channels are watched while the coroutine is suspended, and every change to them makes the executor call
+// try_complete again, so the coroutine is only resumed once the operation has completed or failed
+class Operation {
+public:
+    // Attempts the operation without blocking; returns true once it has completed or failed
+    virtual bool try_complete() = 0;
+
+    // Registers the task's watch on every channel the operation waits on
+    // Returns false, with no watch left registered and the operation failed with GEN_ERROR, if a channel's allocator
+    // runs out
+    virtual bool watch(task_t* task) = 0;
+    // Removes the task's watch from every channel the operation waits on
+    virtual void unwatch(task_t* task) = 0;
+
+protected:
+    ~Operation() = default;
+};
+
+} // namespace detail
+
+// Coroutine type for actors run on an Executor; it starts suspended and only runs once spawned
+// A Task waits on channels by co_awaiting async_send, async_receive or async_select, which suspend it instead of
+// blocking its thread
+class Task {
+public:
+    struct promise_type {
+        // The task pool task that resumes this coroutine
+        task_t task;
+        // Operation the coroutine is suspended on, or nullptr when it is runnable
+        detail::Operation* waiting = nullptr;
+        Executor* executor = nullptr;
+
+        Task get_return_object()
+        {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        // Suspends at the end so the executor, not the coroutine, frees the frame
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    // Frees the coroutine if it was never spawned
+    ~Task()
+    {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+private:
+    friend class Executor;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+// Awaitable base: completes without suspending when the operation is possible right away, and otherwise hands the
+// operation to the task resuming the coroutine
+class Awaitable : public Operation {
+public:
+    bool await_ready()
+    {
+        return try_complete();
+    }
+
+    // The watches go in before the coroutine is counted as suspended, and the executor tries the operation again
+    // right after, so a change between the first attempt and the watch cannot be lost
+    // If the watches cannot be registered the coroutine does not suspend, and resumes with the operation's error
+    bool await_suspend(std::coroutine_handle<Task::promise_type> handle)
+    {
+        Task::promise_type& promise = handle.promise();
+        if (!watch(&promise.task)) {
+            return false;
+        }
+        promise.waiting = this;
+        return true;
+    }
+};
+
+} // namespace detail
+
+// Runs Tasks as task pool tasks: a suspended Task is a task watching the channels of the operation it waits on
+// With num_workers of 0 the executor has no threads and run() drives it from the calling thread
+// At most max_tasks Tasks may be alive at once
+class Executor {
+public:
+    Executor(size_t num_workers, size_t max_tasks) : pool_(task_pool_create(num_workers, max_tasks)), max_tasks_(max_tasks) {}
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Every spawned Task must have finished
+    ~Executor()
+    {
+        assert(outstanding_ == 0);
+        task_pool_destroy(pool_);
+    }
+
+    // Starts running the coroutine; the executor frees it once it finishes
+    void spawn(Task&& task)
+    {
+        std::coroutine_handle<Task::promise_type> handle = std::exchange(task.handle_, nullptr);
+        assert(handle);
+        size_t outstanding = outstanding_.fetch_add(1) + 1;
+        assert(outstanding <= max_tasks_);
+        (void)outstanding;
+        Task::promise_type& promise = handle.promise();
+        promise.executor = this;
+        task_init(&promise.task, pool_, run_task, handle.address());
+        task_schedule(&promise.task);
+    }
+
+    // Returns the number of spawned Tasks that have not finished
+    size_t outstanding() const
+    {
+        return outstanding_;
+    }
+
+protected:
+    // Runs queued Tasks on the calling thread until every spawned Task has finished
+    void run_until_idle()
+    {
+        while (outstanding_ > 0) {
+            enum channel_status status = task_pool_run_one(pool_);
+            assert(status == SUCCESS);
+            (void)status;
+        }
+    }
+
+    // Blocks until every spawned Task has finished
+    void wait_until_idle()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return outstanding_ == 0; });
+    }
+
+private:
+    // Task pool entry point: completes the operation the coroutine waits on and resumes it, until the coroutine
+    // suspends on an operation that cannot complete yet or returns
+    static enum task_result run_task(void* arg)
+    {
+        std::coroutine_handle<Task::promise_type> handle = std::coroutine_handle<Task::promise_type>::from_address(arg);
+        Task::promise_type& promise = handle.promise();
+        while (true) {
+            if (promise.waiting != nullptr) {
+                if (!promise.waiting->try_complete()) {
+                    return TASK_BLOCKED;
+                }
+                promise.waiting->unwatch(&promise.task);
+                promise.waiting = nullptr;
+            }
+            handle.resume();
+            if (handle.done()) {
+                Executor* executor = promise.executor;
+                handle.destroy();
+                executor->finish();
+                return TASK_DONE;
+            }
+        }
+    }
+
+    void finish()
+    {
+        if (outstanding_.fetch_sub(1) == 1) {
+            // take the lock so the wakeup cannot fall between wait_until_idle's check and its wait
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.notify_all();
+        }
+    }
+
+    task_pool_t* pool_;
+    size_t max_tasks_;
+    std::atomic<size_t> outstanding_{0};
+    std::mutex mutex_;
+    std::condition_variable idle_;
+};
+
+// Executor running every Task on the thread that calls run()
+class SingleThreadExecutor : public Executor {
+public:
+    explicit SingleThreadExecutor(size_t max_tasks) : Executor(0, max_tasks) {}
+
+    // Runs Tasks until every spawned Task has finished; Tasks spawned by running Tasks are run too
+    void run()
+    {
+        run_until_idle();
+    }
+};
+
+// Executor running Tasks on num_workers threads of its own
+class ThreadPoolExecutor : public Executor {
+public:
+    ThreadPoolExecutor(size_t num_workers, size_t max_tasks) : Executor(num_workers, max_tasks)
+    {
+        assert(num_workers > 0);
+    }
+
+    // Waits for every spawned Task to finish before stopping the workers
+    ~ThreadPoolExecutor()
+    {
+        wait();
+    }
+
+    // Blocks until every spawned Task has finished
+    void wait()
+    {
+        wait_until_idle();
+    }
+};
+
+namespace detail {
+
+template <typename T, size_t N, typename Value>
+class SendAwaitable : public Awaitable {
+public:
+    SendAwaitable(Channel<T, N>& channel, Value&& value) : channel_(channel), value_(std::forward<Value>(value)) {}
+
+    // Returns SUCCESS, CLOSED_ERROR or GEN_ERROR as Channel::send does
+    enum channel_status await_resume()
+    {
+        return status_;
+    }
+
+    bool try_complete() override
+    {
+        // value_ is only forwarded once a slot is free, so it survives attempts on a full channel
+        status_ = channel_.try_emplace(std::forward<Value>(value_));
+        return status_ != CHANNEL_FULL;
+    }
+
+    bool watch(task_t* task) override
+    {
+        // a closed channel is not watched, but the retry right after suspending sees it closed
+        enum channel_status status = task_watch(task, channel_.select_send().channel);
+        if (status == GEN_ERROR) {
+            status_ = GEN_ERROR;
+            return false;
+        }
+        return true;
+    }
+
+    void unwatch(task_t* task) override
+    {
+        task_unwatch(task, channel_.select_send().channel);
+    }
+
+private:
+    Channel<T, N>& channel_;
+    Value&& value_;
+    enum channel_status status_ = CHANNEL_FULL;
+};
+
+template <typename T, size_t N>
+class ReceiveAwaitable : public Awaitable {
+public:
+    explicit ReceiveAwaitable(Channel<T, N>& channel) : channel_(channel) {}
+
+    // Returns the message, or nothing once the channel is closed or if the task could not wait on it
+    std::optional<T> await_resume()
+    {
+        return std::move(value_);
+    }
+
+    bool try_complete() override
+    {
+        select_t list[1] = {channel_.select_recv()};
+        size_t index = 0;
+        enum channel_status status = channel_non_blocking_select(list, 1, &index);
+        if (status == CHANNEL_EMPTY) {
+            return false;
+        }
+        if (status == SUCCESS) {
+            value_.emplace(channel_.finish_recv(list[0]));
+        }
+        return true;
+    }
+
+    bool watch(task_t* task) override
+    {
+        // a closed channel is not watched, but the retry right after suspending sees it closed
+        enum channel_status status = task_watch(task, channel_.select_recv().channel);
+        return status != GEN_ERROR;
+    }
+
+    void unwatch(task_t* task) override
+    {
+        task_unwatch(task, channel_.select_recv().channel);
+    }
+
+private:
+    Channel<T, N>& channel_;
+    std::optional<T> value_;
+};
+
+class SelectAwaitable : public Awaitable {
+public:
+    SelectAwaitable(select_t* channel_list, size_t channel_count) : list_(channel_list), count_(channel_count) {}
+
+    // Returns the channel_select status; selected_index is the case that completed or failed
+    std::pair<enum channel_status, size_t> await_resume()
+    {
+        return {status_, index_};
+    }
+
+    bool try_complete() override
+    {
+        status_ = channel_non_blocking_select(list_, count_, &index_);
+        if (status_ == SUCCESS) {
+            status_ = complete(index_);
+        }
+        return status_ != CHANNEL_EMPTY;
+    }
+
+    bool watch(task_t* task) override
+    {
+        for (size_t i = 0; i < count_; i++) {
+            if (!seen_before(i)) {
+                enum channel_status status = task_watch(task, list_[i].channel);
+                if (status == GEN_ERROR) {
+                    // fail the whole select at this case, as channel_select does
+                    for (size_t j = 0; j < i; j++) {
+                        if (!seen_before(j)) {
+                            task_unwatch(task, list_[j].channel);
+                        }
+                    }
+                    status_ = GEN_ERROR;
+                    index_ = i;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void unwatch(task_t* task) override
+    {
+        for (size_t i = 0; i < count_; i++) {
+            if (!seen_before(i)) {
+                task_unwatch(task, list_[i].channel);
+            }
+        }
+    }
+
+protected:
+    // Called with the index of the case channel_select completed; returns the status of the whole select
+    virtual enum channel_status complete(size_t)
+    {
+        return SUCCESS;
+    }
+
+private:
+    // A channel may only be watched once, so repeated channels are watched at their first case
+    bool seen_before(size_t i) const
+    {
+        for (size_t j = 0; j < i; j++) {
+            if (list_[j].channel == list_[i].channel) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    select_t* list_;
+    size_t count_;
+    enum channel_status status_ = CHANNEL_EMPTY;
+    size_t index_ = 0;
+};
+
+// Holds the case table ahead of SelectAwaitable, so it is built before SelectAwaitable points into it
+template <typename... Cases>
+struct SelectTableHolder {
+    SelectTable<Cases...> table;
+};
+
+template <typename... Cases>
+class CaseSelectAwaitable : private SelectTableHolder<Cases...>, public SelectAwaitable {
+public:
+    explicit CaseSelectAwaitable(Cases&... cases)
+        : SelectTableHolder<Cases...>{SelectTable<Cases...>(cases...)}, SelectAwaitable(this->table.entries(), sizeof...(Cases))
+    {
+    }
+
+    // SelectAwaitable points into the table, so the awaitable stays where it was built
+    CaseSelectAwaitable(const CaseSelectAwaitable&) = delete;
+    CaseSelectAwaitable& operator=(const CaseSelectAwaitable&) = delete;
+
+protected:
+    enum channel_status complete(size_t index) override
+    {
+        return this->table.complete(index);
+    }
+};
+
+} // namespace detail
+
+// co_await async_send(channel, value) sends value, suspending the Task while the channel is full
+// The result is the channel_status Channel::send would return, or GEN_ERROR if the Task could not wait on the channel
+// The awaitable refers to value, so co_await it in the same expression
+template <typename T, size_t N, typename Value>
+detail::SendAwaitable<T, N, Value> async_send(Channel<T, N>& channel, Value&& value)
+{
+    return detail::SendAwaitable<T, N, Value>(channel, std::forward<Value>(value));
+}
+
+// co_await async_receive(channel) receives a message, suspending the Task while the channel is empty
+// The result is the message, or nothing once the channel is closed or if the Task could not wait on it
+template <typename T, size_t N>
+detail::ReceiveAwaitable<T, N> async_receive(Channel<T, N>& channel)
+{
+    return detail::ReceiveAwaitable<T, N>(channel);
+}
+
+// co_await async_select(channel_list, channel_count) performs channel_select, suspending the Task until one of the
+// cases can complete; the list must stay alive until then
+// The result is the status and selected index channel_select would give; typed channels take part through
+// Channel::select_send/select_recv and are finished with Channel::finish_send/finish_recv as usual
+inline detail::SelectAwaitable async_select(select_t* channel_list, size_t channel_count)
+{
+    return detail::SelectAwaitable(channel_list, channel_count);
+}
+
+// co_await async_select(on_recv(...), on_send(...), ...) is the coroutine form of select: it suspends the Task
+// until a case can complete, then runs that case's handler
+// The result is the status and case index select would return
+template <typename... Cases, std::enable_if_t<detail::are_select_cases<Cases...>, int> = 0>
+detail::CaseSelectAwaitable<std::remove_reference_t<Cases>...> async_select(Cases&&... cases)
+{
+    static_assert(sizeof...(Cases) > 0, "select needs at least one case");
+    return detail::CaseSelectAwaitable<std::remove_reference_t<Cases>...>(cases...);
+}
+
+} // namespace chan
+
+#endif // CHANNEL_CORO_HPP
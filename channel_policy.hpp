@@ -0,0 +1,537 @@
+#ifndef CHANNEL_POLICY_HPP
+#define CHANNEL_POLICY_HPP
+
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+extern "C" {
+#include "channel.h"
+}
+
+// Policy-based channel for comparing locking and waiting strategies per call site without touching channel.c
+// Every policy is a template argument, so the chosen lock and wait code is inlined into send and receive
+namespace chan::policy {
+
+// Tells the CPU that the thread is spinning
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Spins briefly, then yields so a spinning thread cannot starve the one it waits for on a busy machine
+class Backoff {
+public:
+    void pause()
+    {
+        if (spins_ < spin_limit) {
+            spins_++;
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    static constexpr unsigned spin_limit = 128;
+    unsigned spins_ = 0;
+};
+
+// Lock policies; each has a Guard holding the lock for its lifetime, so MCS can keep its queue node on the stack
+
+// Blocking mutex (pthread_mutex_t underneath)
+class MutexLock {
+public:
+    class Guard {
+    public:
+        explicit Guard(MutexLock& lock) : lock_(lock.mutex_) {}
+
+    private:
+        std::lock_guard<std::mutex> lock_;
+    };
+
+private:
+    std::mutex mutex_;
+};
+
+// Test-and-test-and-set spinlock
+class SpinLock {
+public:
+    class Guard {
+    public:
+        explicit Guard(SpinLock& lock) : lock_(lock)
+        {
+            Backoff backoff;
+            while (lock_.locked_.exchange(true, std::memory_order_acquire)) {
+                while (lock_.locked_.load(std::memory_order_relaxed)) {
+                    backoff.pause();
+                }
+            }
+        }
+
+        ~Guard()
+        {
+            lock_.locked_.store(false, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        SpinLock& lock_;
+    };
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+// FIFO ticket lock
+class TicketLock {
+public:
+    class Guard {
+    public:
+        explicit Guard(TicketLock& lock) : lock_(lock)
+        {
+            uint32_t ticket = lock_.next_.fetch_add(1, std::memory_order_relaxed);
+            Backoff backoff;
+            while (lock_.serving_.load(std::memory_order_acquire) != ticket) {
+                backoff.pause();
+            }
+        }
+
+        ~Guard()
+        {
+            lock_.serving_.store(lock_.serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        TicketLock& lock_;
+    };
+
+private:
+    std::atomic<uint32_t> next_{0};
+    std::atomic<uint32_t> serving_{0};
+};
+
+// MCS queue lock; every waiter spins on its own node instead of the shared lock word
+class McsLock {
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::atomic<bool> waiting{true};
+    };
+
+public:
+    class Guard {
+    public:
+        explicit Guard(McsLock& lock) : lock_(lock)
+        {
+            Node* prev = lock_.tail_.exchange(&node_, std::memory_order_acq_rel);
+            if (prev != nullptr) {
+                prev->next.store(&node_, std::memory_order_release);
+                Backoff backoff;
+                while (node_.waiting.load(std::memory_order_acquire)) {
+                    backoff.pause();
+                }
+            }
+        }
+
+        ~Guard()
+        {
+            Node* next = node_.next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                Node* expected = &node_;
+                if (lock_.tail_.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
+                    return;
+                }
+                // a successor swapped itself in but has not linked to us yet
+                Backoff backoff;
+                while ((next = node_.next.load(std::memory_order_acquire)) == nullptr) {
+                    backoff.pause();
+                }
+            }
+            next->waiting.store(false, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        McsLock& lock_;
+        Node node_;
+    };
+
+private:
+    std::atomic<Node*> tail_{nullptr};
+};
+
+// Wait policies; each is an event count: a waiter takes a key under the channel lock, drops the lock and waits
+// until notify has been called since it took the key, so a notify between the two cannot be lost
+
+// Waits on a condition variable
+class CondvarWait {
+public:
+    uint32_t prepare()
+    {
+        waiters_.fetch_add(1, std::memory_order_relaxed);
+        return epoch_.load(std::memory_order_relaxed);
+    }
+
+    void wait(uint32_t key)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this, key] { return epoch_.load(std::memory_order_relaxed) != key; });
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Called with the channel lock held, after the change a waiter may be waiting for
+    void notify()
+    {
+        epoch_.fetch_add(1, std::memory_order_relaxed);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            // the lock orders the epoch bump against a waiter between its check and its sleep
+            std::lock_guard<std::mutex> lock(mutex_);
+            cond_.notify_all();
+        }
+    }
+
+private:
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> waiters_{0};
+    std::mutex mutex_;
+    std::condition_variable cond_;
+};
+
+// Sleeps in the kernel on the event count itself
+class FutexWait {
+public:
+    uint32_t prepare()
+    {
+        waiters_.fetch_add(1, std::memory_order_relaxed);
+        return epoch_.load(std::memory_order_relaxed);
+    }
+
+    void wait(uint32_t key)
+    {
+        // FUTEX_WAIT returns at once if the epoch has already moved on
+        while (epoch_.load(std::memory_order_acquire) == key) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify()
+    {
+        epoch_.fetch_add(1, std::memory_order_release);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+private:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> waiters_{0};
+};
+
+// Never sleeps: spins (then yields) until the event count moves
+class SpinWait {
+public:
+    uint32_t prepare()
+    {
+        return epoch_.load(std::memory_order_relaxed);
+    }
+
+    void wait(uint32_t key)
+    {
+        Backoff backoff;
+        while (epoch_.load(std::memory_order_acquire) == key) {
+            backoff.pause();
+        }
+    }
+
+    void notify()
+    {
+        epoch_.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    std::atomic<uint32_t> epoch_{0};
+};
+
+// Backends hold the ring of messages; the channel only touches them with its lock held
+
+// Ring of N slots stored inline in the channel
+template <size_t N>
+struct InlineRing {
+    static_assert(N > 0, "InlineRing needs at least one slot");
+
+    template <typename T>
+    class Ring {
+    public:
+        Ring() = default;
+
+        size_t capacity() const
+        {
+            return N;
+        }
+
+        T* slot(size_t index)
+        {
+            return std::launder(reinterpret_cast<T*>(slots_[index].storage));
+        }
+
+    private:
+        struct Slot {
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+        std::array<Slot, N> slots_;
+    };
+};
+
+// Ring of a run-time number of slots allocated once at construction
+struct HeapRing {
+    template <typename T>
+    class Ring {
+    public:
+        explicit Ring(size_t capacity) : slots_(new Slot[capacity]), capacity_(capacity)
+        {
+            assert(capacity > 0);
+        }
+
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        T* slot(size_t index)
+        {
+            return std::launder(reinterpret_cast<T*>(slots_[index].storage));
+        }
+
+    private:
+        struct Slot {
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+        std::unique_ptr<Slot[]> slots_;
+        size_t capacity_;
+    };
+};
+
+// Bounded channel of T with the ring, wait strategy and lock chosen at compile time
+// Statuses follow channel.h: SUCCESS, CHANNEL_FULL/CHANNEL_EMPTY from the try_ operations, and CLOSED_ERROR once
+// the channel is closed (close drops messages still buffered, as channel_close does)
+template <typename T, typename Backend, typename WaitPolicy, typename LockPolicy>
+class Channel {
+public:
+    // Arguments go to the backend's ring, e.g. the capacity of a HeapRing
+    template <typename... Args>
+    explicit Channel(Args&&... args) : ring_(std::forward<Args>(args)...)
+    {
+    }
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    // The caller must have stopped every thread using the channel
+    ~Channel()
+    {
+        while (count_ > 0) {
+            ring_.slot(head_)->~T();
+            head_ = next(head_);
+            count_--;
+        }
+    }
+
+    size_t capacity() const
+    {
+        return ring_.capacity();
+    }
+
+    // Constructs a message from args in the ring, waiting while the channel is full
+    template <typename... Args>
+    enum channel_status emplace(Args&&... args)
+    {
+        while (true) {
+            uint32_t key;
+            {
+                typename LockPolicy::Guard guard(lock_);
+                if (closed_) {
+                    return CLOSED_ERROR;
+                }
+                if (count_ < ring_.capacity()) {
+                    push(std::forward<Args>(args)...);
+                    return SUCCESS;
+                }
+                key = not_full_.prepare();
+            }
+            not_full_.wait(key);
+        }
+    }
+
+    enum channel_status send(T&& value)
+    {
+        return emplace(std::move(value));
+    }
+
+    enum channel_status send(const T& value)
+    {
+        return emplace(value);
+    }
+
+    // Same as emplace, except that it returns CHANNEL_FULL instead of waiting
+    template <typename... Args>
+    enum channel_status try_emplace(Args&&... args)
+    {
+        typename LockPolicy::Guard guard(lock_);
+        if (closed_) {
+            return CLOSED_ERROR;
+        }
+        if (count_ == ring_.capacity()) {
+            return CHANNEL_FULL;
+        }
+        push(std::forward<Args>(args)...);
+        return SUCCESS;
+    }
+
+    enum channel_status try_send(T&& value)
+    {
+        return try_emplace(std::move(value));
+    }
+
+    // Moves the next message into out, waiting while the channel is empty
+    enum channel_status receive(T& out)
+    {
+        while (true) {
+            uint32_t key;
+            {
+                typename LockPolicy::Guard guard(lock_);
+                if (closed_) {
+                    return CLOSED_ERROR;
+                }
+                if (count_ > 0) {
+                    pop(out);
+                    return SUCCESS;
+                }
+                key = not_empty_.prepare();
+            }
+            not_empty_.wait(key);
+        }
+    }
+
+    // Returns the next message, waiting while the channel is empty, or nothing once the channel is closed
+    std::optional<T> receive()
+    {
+        std::optional<T> value;
+        while (true) {
+            uint32_t key;
+            {
+                typename LockPolicy::Guard guard(lock_);
+                if (closed_) {
+                    return value;
+                }
+                if (count_ > 0) {
+                    T* slot = ring_.slot(head_);
+                    value.emplace(std::move(*slot));
+                    slot->~T();
+                    advance();
+                    return value;
+                }
+                key = not_empty_.prepare();
+            }
+            not_empty_.wait(key);
+        }
+    }
+
+    // Same as receive(out), except that it returns CHANNEL_EMPTY instead of waiting
+    enum channel_status try_receive(T& out)
+    {
+        typename LockPolicy::Guard guard(lock_);
+        if (closed_) {
+            return CLOSED_ERROR;
+        }
+        if (count_ == 0) {
+            return CHANNEL_EMPTY;
+        }
+        pop(out);
+        return SUCCESS;
+    }
+
+    // Closes the channel and wakes every waiting sender and receiver
+    // Returns SUCCESS, or CLOSED_ERROR if the channel was already closed
+    enum channel_status close()
+    {
+        typename LockPolicy::Guard guard(lock_);
+        if (closed_) {
+            return CLOSED_ERROR;
+        }
+        closed_ = true;
+        not_full_.notify();
+        not_empty_.notify();
+        return SUCCESS;
+    }
+
+private:
+    size_t next(size_t index) const
+    {
+        return index + 1 == ring_.capacity() ? 0 : index + 1;
+    }
+
+    template <typename... Args>
+    void push(Args&&... args)
+    {
+        size_t tail = head_ + count_;
+        if (tail >= ring_.capacity()) {
+            tail -= ring_.capacity();
+        }
+        ::new (static_cast<void*>(ring_.slot(tail))) T(std::forward<Args>(args)...);
+        count_++;
+        not_empty_.notify();
+    }
+
+    void pop(T& out)
+    {
+        T* slot = ring_.slot(head_);
+        out = std::move(*slot);
+        slot->~T();
+        advance();
+    }
+
+    void advance()
+    {
+        head_ = next(head_);
+        count_--;
+        not_full_.notify();
+    }
+
+    typename Backend::template Ring<T> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    bool closed_ = false;
+    LockPolicy lock_;
+    WaitPolicy not_empty_;
+    WaitPolicy not_full_;
+};
+
+} // namespace chan::policy
+
+#endif // CHANNEL_POLICY_HPP
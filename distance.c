@@ -0,0 +1,106 @@
+#include <pthread.h>
+#include "distance.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DISTANCE_X86
+#endif
+
+const distance_t inf_distance = 0x7fffffff;
+
+typedef bool (*min_plus_fn_t)(distance_t* dst, const distance_t* src, distance_t offset, size_t count);
+
+static bool min_plus_scalar(distance_t* dst, const distance_t* src, distance_t offset, size_t count)
+{
+    bool changed = false;
+    for (size_t i = 0; i < count; i++) {
+        // both operands are at most inf_distance, so the sum cannot wrap
+        distance_t new_dist = offset + src[i];
+        if (new_dist > inf_distance) {
+            new_dist = inf_distance;
+        }
+        if (new_dist < dst[i]) {
+            dst[i] = new_dist;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+#ifdef DISTANCE_X86
+__attribute__((target("sse4.1")))
+static bool min_plus_sse41(distance_t* dst, const distance_t* src, distance_t offset, size_t count)
+{
+    const __m128i add = _mm_set1_epi32((int)offset);
+    const __m128i inf = _mm_set1_epi32((int)inf_distance);
+    __m128i diff = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i old_dist = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i sum = _mm_min_epu32(_mm_add_epi32(_mm_loadu_si128((const __m128i*)(src + i)), add), inf);
+        __m128i new_dist = _mm_min_epu32(old_dist, sum);
+        diff = _mm_or_si128(diff, _mm_xor_si128(new_dist, old_dist));
+        _mm_storeu_si128((__m128i*)(dst + i), new_dist);
+    }
+    bool changed = !_mm_testz_si128(diff, diff);
+    return min_plus_scalar(dst + i, src + i, offset, count - i) || changed;
+}
+
+__attribute__((target("avx2")))
+static bool min_plus_avx2(distance_t* dst, const distance_t* src, distance_t offset, size_t count)
+{
+    const __m256i add = _mm256_set1_epi32((int)offset);
+    const __m256i inf = _mm256_set1_epi32((int)inf_distance);
+    __m256i diff = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i old_dist = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i sum = _mm256_min_epu32(_mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(src + i)), add), inf);
+        __m256i new_dist = _mm256_min_epu32(old_dist, sum);
+        diff = _mm256_or_si256(diff, _mm256_xor_si256(new_dist, old_dist));
+        _mm256_storeu_si256((__m256i*)(dst + i), new_dist);
+    }
+    bool changed = !_mm256_testz_si256(diff, diff);
+    return min_plus_scalar(dst + i, src + i, offset, count - i) || changed;
+}
+#endif
+
+// Kernels the CPU supports, slowest first; the last one is used by distance_min_plus
+static distance_min_plus_variant_t min_plus_variants[3] = {{"scalar", min_plus_scalar}};
+static size_t num_min_plus_variants = 1;
+static min_plus_fn_t min_plus_impl = min_plus_scalar;
+static pthread_once_t min_plus_once = PTHREAD_ONCE_INIT;
+
+static void select_min_plus()
+{
+#ifdef DISTANCE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.1")) {
+        min_plus_variants[num_min_plus_variants++] = (distance_min_plus_variant_t){"sse4.1", min_plus_sse41};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        min_plus_variants[num_min_plus_variants++] = (distance_min_plus_variant_t){"avx2", min_plus_avx2};
+    }
+#endif
+    min_plus_impl = min_plus_variants[num_min_plus_variants - 1].min_plus;
+}
+
+// Merges a neighbor's distance vector into dst: dst[i] = min(dst[i], offset + src[i]),
+// with sums at or above inf_distance saturated to inf_distance
+// offset and every src[i] must be at most inf_distance
+// Uses AVX2 or SSE4.1 when the CPU supports them, selected once at runtime
+// Returns true if any entry of dst changed
+bool distance_min_plus(distance_t* dst, const distance_t* src, distance_t offset, size_t count)
+{
+    pthread_once(&min_plus_once, select_min_plus);
+    return min_plus_impl(dst, src, offset, count);
+}
+
+// Returns every min-plus implementation the CPU supports, scalar first and the one distance_min_plus uses last,
+// and stores how many there are in count
+// Only used for testing code; you should NOT use this
+const distance_min_plus_variant_t* distance_min_plus_variants(size_t* count)
+{
+    pthread_once(&min_plus_once, select_min_plus);
+    *count = num_min_plus_variants;
+    return min_plus_variants;
+}
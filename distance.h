@@ -0,0 +1,30 @@
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int distance_t;
+
+// Distance of an unreachable destination; every sum is saturated to this value
+extern const distance_t inf_distance;
+
+// Merges a neighbor's distance vector into dst: dst[i] = min(dst[i], offset + src[i]),
+// with sums at or above inf_distance saturated to inf_distance
+// offset and every src[i] must be at most inf_distance
+// Uses AVX2 or SSE4.1 when the CPU supports them, selected once at runtime
+// Returns true if any entry of dst changed
+bool distance_min_plus(distance_t* dst, const distance_t* src, distance_t offset, size_t count);
+
+// Defines one implementation of distance_min_plus
+typedef struct {
+    const char* name;
+    bool (*min_plus)(distance_t* dst, const distance_t* src, distance_t offset, size_t count);
+} distance_min_plus_variant_t;
+
+// Returns every min-plus implementation the CPU supports, scalar first and the one distance_min_plus uses last,
+// and stores how many there are in count
+// Only used for testing code; you should NOT use this
+const distance_min_plus_variant_t* distance_min_plus_variants(size_t* count);
+
+#endif // DISTANCE_H
@@ -0,0 +1,189 @@
+#include <unistd.h>
+#include <pthread.h>
+#include <assert.h>
+#include "channel.h"
+#include "floyd_warshall.h"
+
+typedef struct {
+    distance_t* matrix;
+    size_t count;
+    // Block index of the intermediate nodes of this round
+    size_t round;
+    // Block coordinates of the tile being updated
+    size_t row;
+    size_t col;
+} tile_t;
+
+typedef struct {
+    channel_t* tasks;
+    channel_t* finished;
+    pthread_t* pid;
+    size_t num_workers;
+} tile_pool_t;
+
+static size_t block_end(size_t block, size_t count)
+{
+    size_t end = (block + 1) * FLOYD_WARSHALL_BLOCK;
+    return end < count ? end : count;
+}
+
+// Relaxes every path of the tile through the intermediates of the round's block
+// Intermediates go in the outer loop, so this is also correct when the tile shares rows or columns with the
+// round's block (the diagonal tile and the tiles in its row and column)
+static void update_tile(const tile_t* tile)
+{
+    size_t count = tile->count;
+    size_t row_end = block_end(tile->row, count);
+    size_t col_start = tile->col * FLOYD_WARSHALL_BLOCK;
+    size_t width = block_end(tile->col, count) - col_start;
+    for (size_t via = tile->round * FLOYD_WARSHALL_BLOCK; via < block_end(tile->round, count); via++) {
+        const distance_t* via_row = tile->matrix + via * count + col_start;
+        for (size_t src = tile->row * FLOYD_WARSHALL_BLOCK; src < row_end; src++) {
+            distance_t to_via = tile->matrix[src * count + via];
+            if (to_via != inf_distance) {
+                distance_min_plus(tile->matrix + src * count + col_start, via_row, to_via, width);
+            }
+        }
+    }
+}
+
+static void* tile_worker(void* arg)
+{
+    tile_pool_t* pool = (tile_pool_t*)arg;
+    void* data = NULL;
+    while (channel_receive(pool->tasks, &data) == SUCCESS) {
+        update_tile((tile_t*)data);
+        enum channel_status status = channel_send(pool->finished, data);
+        assert(status == SUCCESS);
+    }
+    return NULL;
+}
+
+// Updates the independent tiles of one phase, on the pool when there is one
+static void run_tiles(tile_pool_t* pool, tile_t* tiles, size_t num_tiles)
+{
+    if (pool == NULL) {
+        for (size_t i = 0; i < num_tiles; i++) {
+            update_tile(&tiles[i]);
+        }
+        return;
+    }
+    enum channel_status status;
+    for (size_t i = 0; i < num_tiles; i++) {
+        status = channel_send(pool->tasks, &tiles[i]);
+        assert(status == SUCCESS);
+    }
+    for (size_t i = 0; i < num_tiles; i++) {
+        void* data = NULL;
+        status = channel_receive(pool->finished, &data);
+        assert(status == SUCCESS);
+    }
+}
+
+// Both channels hold a whole phase, so the coordinator never blocks while dispatching
+static tile_pool_t* tile_pool_create(size_t num_workers, size_t max_tiles)
+{
+    tile_pool_t* pool = malloc(sizeof(tile_pool_t));
+    assert(pool != NULL);
+    pool->tasks = channel_create(max_tiles);
+    assert(pool->tasks != NULL);
+    pool->finished = channel_create(max_tiles);
+    assert(pool->finished != NULL);
+    pool->pid = malloc(sizeof(pthread_t) * num_workers);
+    assert(pool->pid != NULL);
+    pool->num_workers = num_workers;
+    for (size_t i = 0; i < num_workers; i++) {
+        int pthread_status = pthread_create(&pool->pid[i], NULL, tile_worker, pool);
+        assert(pthread_status == 0);
+    }
+    return pool;
+}
+
+static void tile_pool_destroy(tile_pool_t* pool)
+{
+    enum channel_status status = channel_close(pool->tasks);
+    assert(status == SUCCESS);
+    for (size_t i = 0; i < pool->num_workers; i++) {
+        pthread_join(pool->pid[i], NULL);
+    }
+    status = channel_destroy(pool->tasks);
+    assert(status == SUCCESS);
+    status = channel_close(pool->finished);
+    assert(status == SUCCESS);
+    status = channel_destroy(pool->finished);
+    assert(status == SUCCESS);
+    free(pool->pid);
+    free(pool);
+}
+
+// Computes all-pairs shortest paths in place on the count x count row-major matrix,
+// where matrix[src * count + dst] is the direct link distance (inf_distance if none)
+// Uses the three-phase blocked algorithm: each round solves the diagonal tile, then the tiles in its row and
+// column, then every remaining tile, with the tiles of the last two phases spread over num_threads workers
+// fed through channels; num_threads of 0 uses one worker per online CPU
+void floyd_warshall(distance_t* matrix, size_t count, size_t num_threads)
+{
+    size_t num_blocks = (count + FLOYD_WARSHALL_BLOCK - 1) / FLOYD_WARSHALL_BLOCK;
+    if (num_blocks == 0) {
+        return;
+    }
+    // phase 3 has the most tiles, except with two blocks where phase 2 has 2 against 1
+    size_t max_tiles = (num_blocks - 1) * (num_blocks - 1);
+    if (max_tiles < 2 * (num_blocks - 1)) {
+        max_tiles = 2 * (num_blocks - 1);
+    }
+    if (num_threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (num_threads > max_tiles) {
+        num_threads = max_tiles;
+    }
+    tile_pool_t* pool = num_threads > 1 ? tile_pool_create(num_threads, max_tiles) : NULL;
+    tile_t* tiles = malloc(sizeof(tile_t) * (max_tiles > 0 ? max_tiles : 1));
+    assert(tiles != NULL);
+
+    for (size_t round = 0; round < num_blocks; round++) {
+        // phase 1: the diagonal tile depends only on itself
+        tile_t diagonal = {matrix, count, round, round, round};
+        update_tile(&diagonal);
+        // phase 2: the tiles in the diagonal's row and column depend on themselves and the diagonal
+        size_t num_tiles = 0;
+        for (size_t block = 0; block < num_blocks; block++) {
+            if (block != round) {
+                tiles[num_tiles++] = (tile_t){matrix, count, round, round, block};
+                tiles[num_tiles++] = (tile_t){matrix, count, round, block, round};
+            }
+        }
+        run_tiles(pool, tiles, num_tiles);
+        // phase 3: every other tile reads only the row and column tiles finished in phase 2
+        num_tiles = 0;
+        for (size_t row = 0; row < num_blocks; row++) {
+            for (size_t col = 0; col < num_blocks; col++) {
+                if (row != round && col != round) {
+                    tiles[num_tiles++] = (tile_t){matrix, count, round, row, col};
+                }
+            }
+        }
+        run_tiles(pool, tiles, num_tiles);
+    }
+
+    free(tiles);
+    if (pool != NULL) {
+        tile_pool_destroy(pool);
+    }
+}
+
+// Textbook triple-loop Floyd-Warshall with the same contract as floyd_warshall, used as a reference
+void floyd_warshall_reference(distance_t* matrix, size_t count)
+{
+    for (size_t via = 0; via < count; via++) {
+        for (size_t src = 0; src < count; src++) {
+            for (size_t dst = 0; dst < count; dst++) {
+                if (matrix[src * count + via] + matrix[via * count + dst] < matrix[src * count + dst]) {
+                    matrix[src * count + dst] = matrix[src * count + via] + matrix[via * count + dst];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef FLOYD_WARSHALL_H
+#define FLOYD_WARSHALL_H
+
+#include <stddef.h>
+#include "distance.h"
+
+// Side length of the square tiles processed by floyd_warshall
+// 64x64 distances is 16KB per tile, so the three tiles touched by an update stay in L2
+#define FLOYD_WARSHALL_BLOCK 64
+
+// Computes all-pairs shortest paths in place on the count x count row-major matrix,
+// where matrix[src * count + dst] is the direct link distance (inf_distance if none)
+// Uses the three-phase blocked algorithm: each round solves the diagonal tile, then the tiles in its row and
+// column, then every remaining tile, with the tiles of the last two phases spread over num_threads workers
+// fed through channels; num_threads of 0 uses one worker per online CPU
+void floyd_warshall(distance_t* matrix, size_t count, size_t num_threads);
+
+// Textbook triple-loop Floyd-Warshall with the same contract as floyd_warshall, used as a reference
+void floyd_warshall_reference(distance_t* matrix, size_t count);
+
+#endif // FLOYD_WARSHALL_H
@@ -57,6 +57,7 @@ add_test_case_channel("test_overall_send_receive", iters_one)
 add_test_case_sanitize("test_overall_send_receive", iters_one)
 add_test_case_valgrind("test_overall_send_receive", iters_one, timeout_valgrind * 5)
 add_test_cases("test_stress_send_recv_buffered", iters_one, timeout_stress_send_recv)
+add_test_cases("test_stress_send_recv_topologies", iters_one, timeout_stress_send_recv)
 add_test_cases("test_response_time", iters_one, timeout_response_time)
 add_test_cases("test_cpu_utilization_send", iters_one, timeout_cpu_utilization)
 add_test_cases("test_cpu_utilization_receive", iters_one, timeout_cpu_utilization)
@@ -68,15 +69,34 @@ add_test_case_sanitize("test_channel_close_with_receive", iters_slow)
 add_test_case_valgrind("test_channel_close_with_receive", iters_slow, timeout_valgrind * 2)
 add_test_cases("test_select", iters_slow)
 add_test_cases("test_select_close", iters_slow)
+add_test_cases("test_list_insert_empty")
+add_test_cases("test_select_receive_data")
+add_test_cases("test_select_closed_registration")
 add_test_cases("test_select_and_non_blocking_send_buffered", iters_slow)
 add_test_cases("test_select_and_non_blocking_receive_buffered", iters_slow)
 add_test_cases("test_select_with_select_buffered", iters_slow)
 add_test_cases("test_select_with_same_channel_buffered")
 add_test_cases("test_select_with_send_receive_on_same_channel_buffered")
 add_test_cases("test_select_with_duplicate_channel_buffered", iters_slow)
+add_test_cases("test_channel_allocator", iters_slow)
+add_test_cases("test_distance_min_plus", iters_slow)
+add_test_cases("test_floyd_warshall", iters_one, timeout_stress_send_recv)
+add_test_cases("test_topology_load", iters_slow)
+add_test_cases("test_topology_generate", iters_one, timeout_stress_send_recv)
 add_test_case_channel("test_stress_buffered", iters_one, timeout_channel * 5)
 add_test_case_sanitize("test_stress_buffered", iters_one, timeout_sanitize * 5)
 add_test_case_valgrind("test_stress_buffered", iters_one, timeout_valgrind * 5)
+add_test_case_channel("test_stress_task_pool", iters_one, timeout_channel * 5)
+add_test_case_sanitize("test_stress_task_pool", iters_one, timeout_sanitize * 5)
+add_test_case_valgrind("test_stress_task_pool", iters_one, timeout_valgrind * 5)
+add_test_case_channel("test_stress_large_buffers", iters_one, timeout_channel * 5)
+add_test_case_sanitize("test_stress_large_buffers", iters_one, timeout_sanitize * 5)
+add_test_case_valgrind("test_stress_large_buffers", iters_one, timeout_valgrind * 5)
+add_test_cases("test_cpp_channel", iters_one, timeout_stress_send_recv)
+add_test_cases("test_cpp_coroutines", iters_one, timeout_stress_send_recv)
+add_test_cases("test_cpp_select", iters_slow)
+add_test_cases("test_cpp_policy", iters_one, timeout_stress_send_recv)
+add_test_cases("test_cpp_allocator", iters_slow)
 add_test_cases("test_select_response_time", iters_one, timeout_response_time)
 add_test_cases("test_cpu_utilization_select", iters_one, timeout_cpu_utilization)
 add_test_cases("test_cpu_utilization_overall", iters_one, timeout_cpu_utilization)
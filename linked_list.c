@@ -2,9 +2,19 @@
 
 // Creates and returns a new list
 list_t* list_create() {
-    list_t *list = (list_t*) malloc(sizeof(list_t));
+    return list_create_with_allocator(NULL);
+}
+
+// Creates and returns a new list whose list and node memory comes from the given allocator
+// A NULL allocator uses malloc and free; returns NULL if the allocator runs out of memory
+list_t* list_create_with_allocator(const allocator_t* allocator) {
+    list_t *list = (list_t*) allocator_alloc(allocator, sizeof(list_t));
+    if (list == NULL) {
+        return NULL;
+    }
     list->head = NULL;
     list->count = 0;
+    list->allocator = allocator != NULL ? *allocator : (allocator_t){NULL, NULL, NULL};
     return list;
 }
 
@@ -13,7 +23,8 @@ void list_destroy(list_t* list) {
     while (list->count != 0) {
         list_remove(list, list->head);
     }
-    free(list);
+    allocator_t allocator = list->allocator;
+    allocator_free(&allocator, list, sizeof(list_t));
 }
 
 // Returns beginning of the list
@@ -34,8 +45,7 @@ void* list_data(list_node_t* node) {
 // Returns the number of elements in the list
 size_t list_count(list_t* list)
 {
-    /* IMPLEMENT THIS IF YOU WANT TO USE LINKED LISTS */
-    return 0;
+    return list->count;
 }
 
 // Finds the first node in the list with the given data
@@ -51,21 +61,21 @@ list_node_t* list_find(list_t* list, void* data) {
 }
 
 // Inserts a new node in the list with the given data
-void list_insert(list_t* list, void* data) {
-    list_node_t *node = malloc(sizeof(list_node_t));
+// Returns LIST_SUCCESS, or LIST_ERROR (leaving the list unchanged) if the node could not be allocated
+enum list_status list_insert(list_t* list, void* data) {
+    list_node_t *node = allocator_alloc(&list->allocator, sizeof(list_node_t));
+    if (node == NULL)
+        return LIST_ERROR;
     node->data = data;
-    // if given list empty
-    if (!list->head) {
-        list->head = node;
-        node->next = NULL;
-        node->prev = NULL;
-    }
     list_node_t *curr = list->head;
     list->head = node;
     node->next = curr;
     node->prev = NULL;
-    curr->prev = node;
+    // if given list was not empty
+    if (curr)
+        curr->prev = node;
     list->count += 1;
+    return LIST_SUCCESS;
 }
 
 
@@ -83,7 +93,7 @@ void list_remove(list_t* list, list_node_t* node) {
     node->prev = NULL;
     node->data = NULL;
     list->count -= 1;
-    free(node);
+    allocator_free(&list->allocator, node, sizeof(list_node_t));
 }
 
 // Executes a function for each element in the list
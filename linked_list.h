@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include "allocator.h"
 
 typedef struct list_node {
     struct list_node* next;
@@ -10,14 +11,25 @@ typedef struct list_node {
     void* data;
 } list_node_t;
 
+enum list_status {
+    LIST_SUCCESS = 1,
+    LIST_ERROR = -1
+};
+
 typedef struct {
     list_node_t* head;
     size_t count;
+    // Where the list and its nodes are allocated
+    allocator_t allocator;
 } list_t;
 
 // Creates and returns a new list
 list_t* list_create();
 
+// Creates and returns a new list whose list and node memory comes from the given allocator
+// A NULL allocator uses malloc and free; returns NULL if the allocator runs out of memory
+list_t* list_create_with_allocator(const allocator_t* allocator);
+
 // Destroys a list
 void list_destroy(list_t* list);
 
@@ -38,7 +50,8 @@ size_t list_count(list_t* list);
 list_node_t* list_find(list_t* list, void* data);
 
 // Inserts a new node in the list with the given data
-void list_insert(list_t* list, void* data);
+// Returns LIST_SUCCESS, or LIST_ERROR (leaving the list unchanged) if the node could not be allocated
+enum list_status list_insert(list_t* list, void* data);
 
 // Removes a node from the list and frees the node resources
 void list_remove(list_t* list, list_node_t* node);
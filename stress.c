@@ -1,32 +1,84 @@
-#include <unistd.h>
 #include <pthread.h>
 #include <assert.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
 #include "channel.h"
+#include "distance.h"
+#include "floyd_warshall.h"
+#include "topology.h"
+#include "task_pool.h"
 #include "stress.h"
 
-typedef unsigned int distance_t;
+// Full broadcasts are sent every this many broadcasts, so a lost or misapplied delta cannot persist
+#define STRESS_SNAPSHOT_INTERVAL 16
+
 typedef struct {
     size_t src;
     size_t epoch;
     distance_t dist[0];
 } distance_vector_t;
 
-const distance_t inf_distance = 0x7fffffff;
-distance_t* topology;
+typedef struct {
+    uint32_t dst;
+    distance_t dist;
+} distance_entry_t;
+
+// Distance vector update broadcast by a router to all of its neighbors
+typedef struct {
+    size_t src;
+    // Neighbors that have yet to merge the update; the last one frees it
+    atomic_size_t pending;
+    // Whether entries cover every reachable destination instead of only those changed since the last broadcast
+    bool snapshot;
+    size_t count;
+    distance_entry_t entries[];
+} distance_update_t;
+
+typedef struct {
+    size_t messages;
+    size_t entries;
+    size_t wakeups;
+} router_counters_t;
+
+topology_t* topology;
 distance_t* solution;
-size_t num_channel;
-channel_t** channels;
+static size_t num_channel;
+static channel_t** channels;
+static router_counters_t* counters;
+// Termination detection: the number of update deliveries not yet merged plus the number of routers holding
+// improvements not yet broadcast; a router that was improved takes a unit before releasing the one for the update
+// that improved it, so the count reaches zero exactly once, when the last update is merged and changes nothing
+static atomic_size_t outstanding;
+// Receives one message when outstanding reaches zero
+static channel_t* converged_channel;
+// Receives each router task as it finishes, when routers run on a task pool
+static channel_t* finished_channel;
+static uint64_t converged_ns;
 channel_t* done_channel;
 channel_t* completed_channel;
 
-distance_t get_link_distance(size_t src, size_t dst) {
-    return topology[src * num_channel + dst];
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
 }
 
-void set_link_distance(size_t src, size_t dst, distance_t distance) {
-    topology[src * num_channel + dst] = distance;
+// Releases units of outstanding work and signals convergence if they were the last
+static void release_work(size_t units)
+{
+    if (atomic_fetch_sub(&outstanding, units) == units) {
+        converged_ns = now_ns();
+        enum channel_status status = channel_send(converged_channel, NULL);
+        assert(status == SUCCESS);
+    }
+}
+
+distance_t get_link_distance(size_t src, size_t dst) {
+    return topology_link_distance(topology, src, dst);
 }
 
 distance_t get_solution_distance(size_t src, size_t dst) {
@@ -37,20 +89,6 @@ void set_solution_distance(size_t src, size_t dst, distance_t distance) {
     solution[src * num_channel + dst] = distance;
 }
 
-void floyd_warshall()
-{
-    memcpy(solution, topology, sizeof(distance_t) * num_channel * num_channel);
-    for (size_t intermediate = 0; intermediate < num_channel; intermediate++) {
-        for (size_t src = 0; src < num_channel; src++) {
-            for (size_t dst = 0; dst < num_channel; dst++) {
-                if (get_solution_distance(src, intermediate) + get_solution_distance(intermediate, dst) < get_solution_distance(src, dst)) {
-                    set_solution_distance(src, dst, get_solution_distance(src, intermediate) + get_solution_distance(intermediate, dst));
-                }
-            }
-        }
-    }
-}
-
 void print_graph()
 {
     printf("GRAPH\n");
@@ -83,80 +121,138 @@ void print_solution()
     }
 }
 
-bool create_topology(const char* filename)
+void create_solution()
 {
-    FILE* file = fopen(filename, "r");
-    if (file == NULL) {
-        printf("Could not open topology file: %s\n", filename);
-        return false;
-    }
-    int num_scanned = fscanf(file, "%zu", &num_channel);
-    assert(num_scanned == 1);
-    assert(num_channel > 0);
-    topology = malloc(sizeof(distance_t) * num_channel * num_channel);
-    assert(topology != NULL);
+    // links stay in CSR form; only the solution is a dense matrix
+    num_channel = topology->num_nodes;
     solution = malloc(sizeof(distance_t) * num_channel * num_channel);
     assert(solution != NULL);
-    // populate topology
-    for (size_t src = 0; src < num_channel; src++) {
+    // calculate solution using Floyd-Warshall algorithm
+    topology_to_matrix(topology, solution);
+    floyd_warshall(solution, num_channel, 0);
+}
+
+void destroy_solution()
+{
+    free(solution);
+}
+
+// Builds the update for a broadcast of state to the given number of neighbors and clears the dirty bits
+// A snapshot lists every reachable destination; a delta lists only the destinations marked dirty
+static distance_update_t* create_update(const distance_vector_t* state, uint64_t* dirty, bool snapshot, size_t num_neighbors)
+{
+    size_t num_words = (num_channel + 63) / 64;
+    size_t count = 0;
+    if (snapshot) {
+        for (size_t dst = 0; dst < num_channel; dst++) {
+            count += state->dist[dst] != inf_distance;
+        }
+    } else {
+        for (size_t word = 0; word < num_words; word++) {
+            count += (size_t)__builtin_popcountll(dirty[word]);
+        }
+    }
+    distance_update_t* update = malloc(sizeof(distance_update_t) + sizeof(distance_entry_t) * count);
+    assert(update != NULL);
+    update->src = state->src;
+    atomic_init(&update->pending, num_neighbors);
+    update->snapshot = snapshot;
+    update->count = count;
+    size_t entry = 0;
+    if (snapshot) {
         for (size_t dst = 0; dst < num_channel; dst++) {
-            distance_t distance;
-            num_scanned = fscanf(file, "%d", (int*)&distance);
-            assert(num_scanned == 1);
-            // negative values get converted to inf_distance
-            if (distance > inf_distance) {
-                distance = inf_distance;
+            if (state->dist[dst] != inf_distance) {
+                update->entries[entry++] = (distance_entry_t){(uint32_t)dst, state->dist[dst]};
+            }
+        }
+        memset(dirty, 0, sizeof(uint64_t) * num_words);
+    } else {
+        for (size_t word = 0; word < num_words; word++) {
+            while (dirty[word] != 0) {
+                size_t dst = word * 64 + (size_t)__builtin_ctzll(dirty[word]);
+                dirty[word] &= dirty[word] - 1;
+                update->entries[entry++] = (distance_entry_t){(uint32_t)dst, state->dist[dst]};
             }
-            set_link_distance(src, dst, distance);
         }
     }
-    fclose(file);
-    // calculate solution using Floyd-Warshall algorithm
-    floyd_warshall();
-    return true;
+    return update;
 }
 
-void destroy_topology()
+// Merges a neighbor's update into state, marking every improved destination dirty
+// Replaces distance_min_plus in the router: updates carry sparse (dst, dist) entries rather than a dense vector,
+// so the SIMD kernel, which needs src[i] for every i, has nothing contiguous to run over; it now serves floyd_warshall
+// Returns true if any distance improved
+static bool merge_update(distance_vector_t* state, uint64_t* dirty, const distance_update_t* update, distance_t neighbor_dist)
 {
-    free(topology);
-    free(solution);
+    bool changed = false;
+    for (size_t i = 0; i < update->count; i++) {
+        distance_entry_t entry = update->entries[i];
+        // both operands are below inf_distance, so the sum cannot wrap
+        distance_t new_dist = neighbor_dist + entry.dist;
+        if (new_dist < state->dist[entry.dst]) {
+            state->dist[entry.dst] = new_dist;
+            dirty[entry.dst / 64] |= 1ull << (entry.dst % 64);
+            changed = true;
+        }
+    }
+    return changed;
 }
 
-void* router(void* arg)
+typedef struct {
+    size_t index;
+    // Whether state holds improvements not yet broadcast
+    bool changed;
+    size_t broadcasts;
+    // Neighbors only ever see the updates copied out of it, so any number of them can be in flight per channel;
+    // its epoch counts broadcasts
+    distance_vector_t* state;
+    // destinations improved in state since the last broadcast
+    uint64_t* dirty;
+    size_t num_neighbors;
+    // Update being broadcast; the last neighbor to merge it frees it, possibly before our own select returns,
+    // so its entry count is kept separately
+    distance_update_t* update;
+    size_t update_count;
+    // done_channel, our own channel, then one send per neighbor; sends still to do come first
+    select_t* select_list;
+    size_t select_count;
+    size_t total_select_count;
+    // Used when routers run as tasks on a pool instead of on their own threads
+    task_t task;
+} router_t;
+
+static void router_init(router_t* router, size_t index)
 {
-    bool changed = false;
-    size_t index = (size_t)arg;
-    size_t selected_index;
-    distance_vector_t* prev_prev_state = malloc(sizeof(distance_vector_t) + sizeof(distance_t) * num_channel);
-    assert(prev_prev_state != NULL);
-    distance_vector_t* prev_state = malloc(sizeof(distance_vector_t) + sizeof(distance_t) * num_channel);
-    assert(prev_state != NULL);
-    distance_vector_t* curr_state = malloc(sizeof(distance_vector_t) + sizeof(distance_t) * num_channel);
-    assert(curr_state != NULL);
-    distance_vector_t* next_state = malloc(sizeof(distance_vector_t) + sizeof(distance_t) * num_channel);
-    assert(next_state != NULL);
-    prev_prev_state->src = index;
-    prev_state->src = index;
-    curr_state->src = index;
-    next_state->src = index;
-    prev_prev_state->epoch = 0;
-    prev_state->epoch = 1;
-    curr_state->epoch = 2;
-    next_state->epoch = 3;
+    router->index = index;
+    router->changed = false;
+    router->broadcasts = 0;
+    router->state = malloc(sizeof(distance_vector_t) + sizeof(distance_t) * num_channel);
+    assert(router->state != NULL);
+    router->dirty = calloc((num_channel + 63) / 64, sizeof(uint64_t));
+    assert(router->dirty != NULL);
+    router->state->src = index;
+    router->state->epoch = 0;
     for (size_t i = 0; i < num_channel; i++) {
-        prev_prev_state->dist[i] = get_link_distance(index, i);
-        prev_state->dist[i] = get_link_distance(index, i);
-        curr_state->dist[i] = get_link_distance(index, i);
-        next_state->dist[i] = get_link_distance(index, i);
+        router->state->dist[i] = inf_distance;
     }
-    size_t total_select_count = 2;
-    for (size_t i = 0; i < num_channel; i++) {
-        if ((i != index) && get_link_distance(index, i) != inf_distance) {
-            total_select_count++;
-        }
+    router->state->dist[index] = 0;
+    uint64_t first_link = topology->offsets[index];
+    uint64_t last_link = topology->offsets[index + 1];
+    for (uint64_t link = first_link; link < last_link; link++) {
+        router->state->dist[topology->targets[link]] = topology->weights[link];
     }
-    select_t* select_list = malloc(sizeof(select_t) * total_select_count);
-    assert(select_list != NULL);
+    router->num_neighbors = (size_t)(last_link - first_link);
+    router->total_select_count = 2 + router->num_neighbors;
+    // the first broadcast is always a snapshot
+    router->update = router->num_neighbors > 0 ? create_update(router->state, router->dirty, true, router->num_neighbors) : NULL;
+    router->update_count = router->update != NULL ? router->update->count : 0;
+    router->broadcasts++;
+    // account for the first update before giving up the unit run_stress_topology holds for this router
+    atomic_fetch_add(&outstanding, router->num_neighbors);
+    release_work(1);
+    router->select_list = malloc(sizeof(select_t) * router->total_select_count);
+    assert(router->select_list != NULL);
+    select_t* select_list = router->select_list;
     size_t select_count = 0;
     select_list[select_count].channel = done_channel;
     select_list[select_count].dir = RECV;
@@ -166,87 +262,140 @@ void* router(void* arg)
     select_list[select_count].dir = RECV;
     select_list[select_count].data = NULL;
     select_count++;
-    for (size_t i = 0; i < num_channel; i++) {
-        if ((i != index) && get_link_distance(index, i) != inf_distance) {
-            select_list[select_count].channel = channels[i];
-            select_list[select_count].dir = SEND;
-            select_list[select_count].data = curr_state;
-            select_count++;
+    for (uint64_t link = first_link; link < last_link; link++) {
+        select_list[select_count].channel = channels[topology->targets[link]];
+        select_list[select_count].dir = SEND;
+        select_list[select_count].data = router->update;
+        select_count++;
+    }
+    router->select_count = select_count;
+}
+
+// Handles the operation channel_select completed at selected_index
+static void router_handle(router_t* router, size_t selected_index)
+{
+    enum channel_status status;
+    size_t index = router->index;
+    select_t* select_list = router->select_list;
+    assert(selected_index != 0);
+    if (selected_index == 1) {
+        if (select_list[selected_index].data) {
+            // update state with new data
+            distance_update_t* neighbor_update = select_list[selected_index].data;
+            distance_t neighbor_dist = get_link_distance(index, neighbor_update->src);
+            assert(neighbor_dist != inf_distance);
+            if (merge_update(router->state, router->dirty, neighbor_update, neighbor_dist) && !router->changed) {
+                // hold a unit until the improvement is broadcast
+                atomic_fetch_add(&outstanding, 1);
+                router->changed = true;
+            }
+            if (atomic_fetch_sub(&neighbor_update->pending, 1) == 1) {
+                free(neighbor_update);
+            }
+            release_work(1);
+        } else {
+            // special message sent to test convergence
+            bool converged = (router->select_count == 2) && !router->changed;
+            status = channel_send(completed_channel, converged ? router->state : NULL);
+            assert(status == SUCCESS);
         }
+    } else {
+        counters[index].messages++;
+        counters[index].entries += router->update_count;
+        router->select_count--;
+        // swap last element and selected element
+        channel_t* temp = select_list[router->select_count].channel;
+        select_list[router->select_count].channel = select_list[selected_index].channel;
+        select_list[selected_index].channel = temp;
     }
-    while (true) {
-        enum channel_status status = channel_select(select_list, select_count, &selected_index);
-        if (status == SUCCESS) {
-            assert(selected_index != 0);
-            if (selected_index == 1) {
-                if (select_list[selected_index].data) {
-                    // update next_state with new data
-                    distance_vector_t* neighbor_state = select_list[selected_index].data;
-                    distance_t neighbor_dist = get_link_distance(index, neighbor_state->src);
-                    assert(neighbor_dist != inf_distance);
-                    for (size_t i = 0; i < num_channel; i++) {
-                        distance_t new_dist = neighbor_dist + neighbor_state->dist[i];
-                        if (new_dist < next_state->dist[i]) {
-                            next_state->dist[i] = new_dist;
-                            changed = true;
-                        }
-                    }
-                } else {
-                    // special message sent to test convergence
-                    bool converged = (select_count == 2) && !changed;
-                    status = channel_send(completed_channel, converged ? curr_state : NULL);
-                    assert(status == SUCCESS);
-                }
+    // check if we've sent to everyone
+    if (router->select_count == 2) {
+        // check if we want to reset
+        if (router->changed) {
+            // reset to broadcast again; neighbors free the previous update once they have merged it
+            router->state->epoch++;
+            if (router->num_neighbors > 0) {
+                bool snapshot = router->broadcasts % STRESS_SNAPSHOT_INTERVAL == 0;
+                router->update = create_update(router->state, router->dirty, snapshot, router->num_neighbors);
+                router->update_count = router->update->count;
             } else {
-                select_count--;
-                // swap last element and selected element
-                channel_t* temp = select_list[select_count].channel;
-                select_list[select_count].channel = select_list[selected_index].channel;
-                select_list[selected_index].channel = temp;
+                memset(router->dirty, 0, sizeof(uint64_t) * ((num_channel + 63) / 64));
             }
-            // check if we've sent to everyone
-            if (select_count == 2) {
-                // check if we want to reset
-                if (changed) {
-                    // cycle triple buffer
-                    distance_vector_t* temp_state = curr_state;
-                    curr_state = next_state;
-                    next_state = prev_prev_state;
-                    prev_prev_state = prev_state;
-                    prev_state = temp_state;
-                    next_state->epoch = curr_state->epoch + 1;
-                    for (size_t i = 0; i < num_channel; i++) {
-                        next_state->dist[i] = curr_state->dist[i];
-                    }
-                    // reset to broadcast again
-                    select_count = total_select_count;
-                    for (size_t i = 2; i < select_count; i++) {
-                        select_list[i].data = curr_state;
-                    }
-                    changed = false;
-                }
+            router->broadcasts++;
+            router->select_count = router->total_select_count;
+            for (size_t i = 2; i < router->select_count; i++) {
+                select_list[i].data = router->update;
             }
-        } else {
+            atomic_fetch_add(&outstanding, router->num_neighbors);
+            release_work(1);
+            router->changed = false;
+        }
+    }
+}
+
+static void router_destroy(router_t* router)
+{
+    assert(router->changed == false);
+    free(router->select_list);
+    free(router->dirty);
+    free(router->state);
+}
+
+void* router(void* arg)
+{
+    router_t* router = (router_t*)arg;
+    while (true) {
+        size_t selected_index;
+        enum channel_status status = channel_select(router->select_list, router->select_count, &selected_index);
+        counters[router->index].wakeups++;
+        if (status != SUCCESS) {
             assert(status == CLOSED_ERROR);
             assert(selected_index == 0);
-            assert(changed == false);
             break;
         }
+        router_handle(router, selected_index);
     }
-    free(select_list);
-    free(prev_prev_state);
-    free(prev_state);
-    free(curr_state);
-    free(next_state);
+    router_destroy(router);
     return NULL;
 }
 
+// Task version of router: handles every operation that is ready, then blocks until a watched channel changes
+static enum task_result router_task(void* arg)
+{
+    router_t* router = (router_t*)arg;
+    counters[router->index].wakeups++;
+    while (true) {
+        size_t selected_index;
+        enum channel_status status = channel_non_blocking_select(router->select_list, router->select_count, &selected_index);
+        if (status == CHANNEL_EMPTY) {
+            return TASK_BLOCKED;
+        }
+        if (status != SUCCESS) {
+            assert(status == CLOSED_ERROR);
+            assert(selected_index == 0);
+            break;
+        }
+        router_handle(router, selected_index);
+    }
+    for (size_t i = 0; i < router->total_select_count; i++) {
+        enum channel_status status = task_unwatch(&router->task, router->select_list[i].channel);
+        assert(status == SUCCESS);
+    }
+    router_destroy(router);
+    enum channel_status status = channel_send(finished_channel, router);
+    assert(status == SUCCESS);
+    return TASK_DONE;
+}
+
 bool check_done()
 {
     bool valid = true;
     enum channel_status status;
     distance_vector_t** completed = malloc(sizeof(distance_vector_t*) * num_channel);
     assert(completed != NULL);
+    // every router replies with the same vector each time, so keep the epochs it had in the first round
+    size_t* epochs = malloc(sizeof(size_t) * num_channel);
+    assert(epochs != NULL);
     // validate by sending special NULL message to flush channels
     for (size_t i = 0; i < num_channel; i++) {
         status = channel_send(channels[i], NULL);
@@ -263,6 +412,7 @@ bool check_done()
             distance_vector_t* new_data = (distance_vector_t*)data;
             size_t index = new_data->src;
             completed[index] = new_data;
+            epochs[index] = new_data->epoch;
         }
     }
     if (valid) {
@@ -281,7 +431,7 @@ bool check_done()
             } else {
                 distance_vector_t* new_data = (distance_vector_t*)data;
                 size_t index = new_data->src;
-                if (completed[index]->epoch != new_data->epoch) {
+                if (epochs[index] != new_data->epoch) {
                     valid = false;
                 }
             }
@@ -295,18 +445,17 @@ bool check_done()
             }
         }
     }
+    free(epochs);
     free(completed);
     return valid;
 }
 
-void run_stress(size_t main_buffer_size, size_t secondary_buffer_size, const char* filename)
+void run_stress_topology(size_t main_buffer_size, size_t secondary_buffer_size, topology_t* links, size_t num_workers, stress_stats_t* stats)
 {
-    assert(main_buffer_size <= 1); // only support up to a buffer size of 1
-    assert(secondary_buffer_size <= 1); // only support up to a buffer size of 1
     int pthread_status;
     enum channel_status status;
-    bool initialized = create_topology(filename);
-    assert(initialized);
+    topology = links;
+    create_solution();
     channels = malloc(sizeof(channel_t*) * num_channel);
     assert(channels != NULL);
     for (size_t i = 0; i < num_channel; i++) {
@@ -317,26 +466,85 @@ void run_stress(size_t main_buffer_size, size_t secondary_buffer_size, const cha
     assert(done_channel != NULL);
     completed_channel = channel_create(secondary_buffer_size);
     assert(completed_channel != NULL);
+    converged_channel = channel_create(1);
+    assert(converged_channel != NULL);
+    // one unit per router until it has accounted for its first update
+    atomic_init(&outstanding, num_channel);
 
-    pthread_t* pid = malloc(sizeof(pthread_t) * num_channel);
-    assert(pid != NULL);
+    counters = calloc(num_channel, sizeof(router_counters_t));
+    assert(counters != NULL);
+    router_t* routers = malloc(sizeof(router_t) * num_channel);
+    assert(routers != NULL);
+    pthread_t* pid = NULL;
+    task_pool_t* pool = NULL;
+    uint64_t start_ns = now_ns();
     for (size_t i = 0; i < num_channel; i++) {
-        pthread_status = pthread_create(&pid[i], NULL, router, (void*)i);
-        assert(pthread_status == 0);
+        router_init(&routers[i], i);
     }
-
-    // wait for convergence
-    while (!check_done()) {
-        usleep(1000);
+    if (num_workers == 0) {
+        pid = malloc(sizeof(pthread_t) * num_channel);
+        assert(pid != NULL);
+        for (size_t i = 0; i < num_channel; i++) {
+            pthread_status = pthread_create(&pid[i], NULL, router, &routers[i]);
+            assert(pthread_status == 0);
+        }
+    } else {
+        finished_channel = channel_create(num_channel);
+        assert(finished_channel != NULL);
+        pool = task_pool_create(num_workers, num_channel);
+        for (size_t i = 0; i < num_channel; i++) {
+            task_init(&routers[i].task, pool, router_task, &routers[i]);
+            for (size_t j = 0; j < routers[i].total_select_count; j++) {
+                status = task_watch(&routers[i].task, routers[i].select_list[j].channel);
+                assert(status == SUCCESS);
+            }
+        }
+        for (size_t i = 0; i < num_channel; i++) {
+            task_schedule(&routers[i].task);
+        }
     }
 
-    // stop threads
+    // wait for convergence, then validate the converged distance vectors once
+    void* data = NULL;
+    status = channel_receive(converged_channel, &data);
+    assert(status == SUCCESS);
+    bool valid = check_done();
+    assert(valid);
+
+    // stop routers
     status = channel_close(done_channel);
     assert(status == SUCCESS);
-    // join threads
-    for (size_t i = 0; i < num_channel; i++) {
-        pthread_join(pid[i], NULL);
+    if (num_workers == 0) {
+        // join threads
+        for (size_t i = 0; i < num_channel; i++) {
+            pthread_join(pid[i], NULL);
+        }
+        free(pid);
+    } else {
+        // wait for every task to finish before stopping the workers
+        for (size_t i = 0; i < num_channel; i++) {
+            status = channel_receive(finished_channel, &data);
+            assert(status == SUCCESS);
+        }
+        task_pool_destroy(pool);
+        status = channel_close(finished_channel);
+        assert(status == SUCCESS);
+        status = channel_destroy(finished_channel);
+        assert(status == SUCCESS);
+    }
+    free(routers);
+    if (stats != NULL) {
+        stats->convergence_ns = converged_ns - start_ns;
+        stats->messages = 0;
+        stats->entries = 0;
+        stats->wakeups = 0;
+        for (size_t i = 0; i < num_channel; i++) {
+            stats->messages += counters[i].messages;
+            stats->entries += counters[i].entries;
+            stats->wakeups += counters[i].wakeups;
+        }
     }
+    free(counters);
     // cleanup
     status = channel_destroy(done_channel);
     assert(status == SUCCESS);
@@ -344,13 +552,25 @@ void run_stress(size_t main_buffer_size, size_t secondary_buffer_size, const cha
     assert(status == SUCCESS);
     status = channel_destroy(completed_channel);
     assert(status == SUCCESS);
+    status = channel_close(converged_channel);
+    assert(status == SUCCESS);
+    status = channel_destroy(converged_channel);
+    assert(status == SUCCESS);
     for (size_t i = 0; i < num_channel; i++) {
         status = channel_close(channels[i]);
         assert(status == SUCCESS);
         status = channel_destroy(channels[i]);
         assert(status == SUCCESS);
     }
-    free(pid);
     free(channels);
-    destroy_topology();
+    destroy_solution();
+    topology = NULL;
+}
+
+void run_stress(size_t main_buffer_size, size_t secondary_buffer_size, const char* filename)
+{
+    topology_t* links = topology_load(filename);
+    assert(links != NULL);
+    run_stress_topology(main_buffer_size, secondary_buffer_size, links, 0, NULL);
+    topology_destroy(links);
 }
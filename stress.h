@@ -1,6 +1,27 @@
 #ifndef STRESS_H
 #define STRESS_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "topology.h"
+
+typedef struct {
+    // Time from starting the routers until the in-flight work counter drained, before any validation runs
+    uint64_t convergence_ns;
+    // Distance vector updates sent from routers to their neighbors
+    size_t messages;
+    // (destination, distance) entries carried by those updates
+    size_t entries;
+    // Times a router woke up: channel_select returns for router threads, runs for router tasks
+    size_t wakeups;
+} stress_stats_t;
+
 void run_stress(size_t main_buffer_size, size_t secondary_buffer_size, const char* filename);
 
+// Runs the router stress test on an already loaded topology, which the caller keeps ownership of
+// With num_workers of 0 every router gets its own thread blocking in channel_select; otherwise the routers run as
+// event-driven tasks multiplexed on a pool of num_workers threads, woken through channel watches
+// Fills in stats when it is not NULL
+void run_stress_topology(size_t main_buffer_size, size_t secondary_buffer_size, topology_t* topology, size_t num_workers, stress_stats_t* stats);
+
 #endif // STRESS_H
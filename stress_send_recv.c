@@ -2,23 +2,105 @@
 #include <pthread.h>
 #include <assert.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <stdatomic.h>
+#include <time.h>
 #include "channel.h"
 #include "stress_send_recv.h"
 
-size_t num_channel;
-channel_t** channels;
+// Heap message used by SEND_RECV_BOXED
+typedef struct {
+    size_t id;
+    size_t hops;
+    unsigned char bytes[];
+} message_box_t;
+
+typedef struct {
+    // Hops forwarded by this worker; each worker has its own cache line, so relaxed increments never contend
+    _Alignas(64) atomic_size_t hops;
+    uint64_t random;
+    // Messages received but not yet forwarded, as a ring of num_msgs + 1 slots (SEND_RECV_RING keeps none)
+    void** backlog;
+    size_t head;
+    size_t count;
+} worker_t;
+
+static size_t num_channel;
+static channel_t** channels;
+static send_recv_config_t config;
+static worker_t* workers;
 volatile atomic_bool done;
 channel_t* main_channel;
 
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Returns the next value of a xorshift64 state
+static uint64_t next_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Returns the worker that a message leaving the given worker goes to next
+static size_t next_worker(size_t index)
+{
+    switch (config.topology) {
+        case SEND_RECV_MULTI_RING: {
+            size_t ring_size = num_channel / config.num_rings;
+            size_t base = index - index % ring_size;
+            return base + (index - base + 1) % ring_size;
+        }
+        case SEND_RECV_ALL_TO_ALL: {
+            size_t other = (size_t)(next_random(&workers[index].random) % (num_channel - 1));
+            return other >= index ? other + 1 : other;
+        }
+        case SEND_RECV_TREE: {
+            // parent first, then children, in binary heap order
+            size_t neighbors[3];
+            size_t num_neighbors = 0;
+            if (index > 0) {
+                neighbors[num_neighbors++] = (index - 1) / 2;
+            }
+            for (size_t child = 2 * index + 1; child <= 2 * index + 2 && child < num_channel; child++) {
+                neighbors[num_neighbors++] = child;
+            }
+            return neighbors[next_random(&workers[index].random) % num_neighbors];
+        }
+        case SEND_RECV_RING:
+        default:
+            return index + 1 < num_channel ? index + 1 : 0;
+    }
+}
+
+// Does the per-hop work on a message: boxed payloads are read and written, as a real handoff would
+static void touch_message(void* data)
+{
+    if (config.payload == SEND_RECV_BOXED) {
+        message_box_t* box = (message_box_t*)data;
+        box->hops++;
+        for (size_t i = 0; i < config.payload_size; i += 64) {
+            box->bytes[i]++;
+        }
+    }
+}
+
+static size_t message_id(void* data)
+{
+    return config.payload == SEND_RECV_BOXED ? ((message_box_t*)data)->id : (size_t)data;
+}
+
 void* worker_thread(void* arg)
 {
     size_t index = (size_t)arg;
-    size_t next_index = index + 1;
-    if (next_index >= num_channel) {
-        next_index = 0;
-    }
+    size_t next_index = next_worker(index);
     channel_t* my_channel = channels[index];
     channel_t* next_channel = channels[next_index];
     bool start = true;
@@ -47,43 +129,189 @@ void* worker_thread(void* arg)
             assert(status == SUCCESS);
         } else {
             // Pass along message to next thread in ring
+            touch_message(data);
             status = channel_send(next_channel, data);
             assert(status == SUCCESS);
+            atomic_fetch_add_explicit(&workers[index].hops, 1, memory_order_relaxed);
         }
     }
     return NULL;
 }
 
+static void backlog_push(worker_t* worker, void* data)
+{
+    size_t capacity = config.num_msgs + 1;
+    assert(worker->count < capacity);
+    worker->backlog[(worker->head + worker->count) % capacity] = data;
+    worker->count++;
+}
+
+static void* backlog_pop(worker_t* worker)
+{
+    void* data = worker->backlog[worker->head];
+    worker->head = (worker->head + 1) % (config.num_msgs + 1);
+    worker->count--;
+    return data;
+}
+
+// Worker for every topology but SEND_RECV_RING
+// Selects between receiving on its own channel and sending the oldest backlog message to its next worker,
+// so a full neighbor never stops it from draining its own channel
+void* forwarding_thread(void* arg)
+{
+    size_t index = (size_t)arg;
+    worker_t* worker = &workers[index];
+    enum channel_status status;
+    void* data = NULL;
+    // take messages until the start period is over
+    while (true) {
+        status = channel_receive(main_channel, &data);
+        assert(status == SUCCESS);
+        if (data == NULL) {
+            break;
+        }
+        backlog_push(worker, data);
+    }
+    select_t select_list[2];
+    select_list[0].channel = channels[index];
+    select_list[0].dir = RECV;
+    select_list[1].dir = SEND;
+    size_t target = next_worker(index);
+    while (!atomic_load(&done)) {
+        size_t select_count = 1;
+        select_list[0].data = NULL;
+        if (worker->count > 0) {
+            select_list[1].channel = channels[target];
+            select_list[1].data = worker->backlog[worker->head];
+            select_count = 2;
+        }
+        size_t selected_index;
+        status = channel_select(select_list, select_count, &selected_index);
+        assert(status == SUCCESS);
+        if (selected_index == 0) {
+            if (select_list[0].data == NULL) {
+                // stop message: done was set while this worker sat idle, and every message is already back
+                assert(worker->count == 0);
+                return NULL;
+            }
+            // touch on receipt: once selected for send, the message already belongs to the next worker
+            touch_message(select_list[0].data);
+            backlog_push(worker, select_list[0].data);
+        } else {
+            backlog_pop(worker);
+            atomic_fetch_add_explicit(&worker->hops, 1, memory_order_relaxed);
+            target = next_worker(index);
+        }
+    }
+    // return everything to main_channel until the stop message
+    while (worker->count > 0) {
+        status = channel_send(main_channel, backlog_pop(worker));
+        assert(status == SUCCESS);
+    }
+    while (true) {
+        status = channel_receive(channels[index], &data);
+        assert(status == SUCCESS);
+        if (data == NULL) {
+            break;
+        }
+        status = channel_send(main_channel, data);
+        assert(status == SUCCESS);
+    }
+    return NULL;
+}
+
+static size_t total_hops()
+{
+    size_t hops = 0;
+    for (size_t i = 0; i < num_channel; i++) {
+        hops += atomic_load_explicit(&workers[i].hops, memory_order_relaxed);
+    }
+    return hops;
+}
+
 void run_stress_send_recv(size_t buffer_size, size_t num_threads, double load, useconds_t duration_usec)
+{
+    send_recv_config_t ring = {
+        .buffer_size = buffer_size,
+        .num_threads = num_threads,
+        .topology = SEND_RECV_RING,
+        .num_rings = 1,
+        .num_msgs = 0,
+        .load = load,
+        .payload = SEND_RECV_INLINE,
+        .payload_size = 0,
+        .duration_usec = duration_usec,
+    };
+    run_stress_send_recv_config(&ring, NULL);
+}
+
+// Circulates messages between worker threads for the configured duration, checks that every message comes back
+// exactly once, and fills in stats (if not NULL) from relaxed per-thread hop counters
+// Topologies other than SEND_RECV_RING forward through channel_select with a local backlog, so they cannot deadlock
+// however the hops line up
+void run_stress_send_recv_config(const send_recv_config_t* run_config, send_recv_stats_t* stats)
 {
     enum channel_status status;
     // setup
-    num_channel = num_threads;
+    config = *run_config;
+    num_channel = config.num_threads;
+    assert(num_channel > 0);
+    assert(config.topology != SEND_RECV_MULTI_RING || (config.num_rings > 0 && num_channel % config.num_rings == 0));
+    assert(config.topology == SEND_RECV_RING || config.topology == SEND_RECV_MULTI_RING || num_channel > 1);
     atomic_store(&done, false);
-    size_t num_msgs = (size_t)(((double)(num_channel * (buffer_size + 1))) * load);
+    if (config.num_msgs == 0) {
+        config.num_msgs = (size_t)(((double)(num_channel * (config.buffer_size + 1))) * config.load);
+    }
+    size_t num_msgs = config.num_msgs;
     bool* msg_check = calloc(num_msgs + 1, sizeof(bool));
     assert(msg_check != NULL);
+    void** messages = malloc(sizeof(void*) * (num_msgs + 1));
+    assert(messages != NULL);
+    for (size_t msg = 1; msg <= num_msgs; msg++) {
+        if (config.payload == SEND_RECV_BOXED) {
+            message_box_t* box = calloc(1, sizeof(message_box_t) + config.payload_size);
+            assert(box != NULL);
+            box->id = msg;
+            messages[msg] = box;
+        } else {
+            messages[msg] = (void*)msg;
+        }
+    }
 
+    workers = aligned_alloc(64, sizeof(worker_t) * num_channel);
+    assert(workers != NULL);
+    for (size_t i = 0; i < num_channel; i++) {
+        atomic_init(&workers[i].hops, 0);
+        workers[i].random = 0x9e3779b97f4a7c15ull * (i + 1);
+        workers[i].head = 0;
+        workers[i].count = 0;
+        workers[i].backlog = NULL;
+        if (config.topology != SEND_RECV_RING) {
+            workers[i].backlog = malloc(sizeof(void*) * (num_msgs + 1));
+            assert(workers[i].backlog != NULL);
+        }
+    }
     channels = malloc(sizeof(channel_t*) * num_channel);
     assert(channels != NULL);
     for (size_t i = 0; i < num_channel; i++) {
-        channels[i] = channel_create(buffer_size);
+        channels[i] = channel_create(config.buffer_size);
         assert(channels[i] != NULL);
     }
-    main_channel = channel_create(buffer_size);
+    main_channel = channel_create(config.buffer_size);
     assert(main_channel != NULL);
 
     pthread_t* pid = malloc(sizeof(pthread_t) * num_channel);
     assert(pid != NULL);
     for (size_t i = 0; i < num_channel; i++) {
-        int pthread_status = pthread_create(&pid[i], NULL, worker_thread, (void*)i);
+        void* (*thread)(void*) = config.topology == SEND_RECV_RING ? worker_thread : forwarding_thread;
+        int pthread_status = pthread_create(&pid[i], NULL, thread, (void*)i);
         assert(pthread_status == 0);
     }
 
     // start test
     for (size_t msg = 1; msg <= num_msgs; msg++) {
         // insert data into threads
-        status = channel_send(main_channel, (void*)msg);
+        status = channel_send(main_channel, messages[msg]);
         assert(status == SUCCESS);
     }
     for (size_t i = 0; i < num_channel; i++) {
@@ -91,21 +319,26 @@ void run_stress_send_recv(size_t buffer_size, size_t num_threads, double load, u
         status = channel_send(main_channel, NULL);
         assert(status == SUCCESS);
     }
+    uint64_t start_ns = now_ns();
+    size_t start_hops = total_hops();
 
     // wait for duration
-    usleep(duration_usec);
+    usleep(config.duration_usec);
 
     // stop test
     atomic_store(&done, true);
+    uint64_t end_ns = now_ns();
+    size_t end_hops = total_hops();
     for (size_t msg = 1; msg <= num_msgs; msg++) {
         // pull data from threads
-        size_t data = 0;
-        status = channel_receive(main_channel, (void**)&data);
+        void* data = NULL;
+        status = channel_receive(main_channel, &data);
         assert(status == SUCCESS);
         // check that data wasn't duplicated
-        assert((1 <= data) && (data <= num_msgs));
-        assert(msg_check[data] == false);
-        msg_check[data] = true;
+        size_t id = message_id(data);
+        assert((1 <= id) && (id <= num_msgs));
+        assert(msg_check[id] == false);
+        msg_check[id] = true;
     }
 
     // shutdown
@@ -118,6 +351,10 @@ void run_stress_send_recv(size_t buffer_size, size_t num_threads, double load, u
         // join threads
         pthread_join(pid[i], NULL);
     }
+    if (stats != NULL) {
+        stats->hops = end_hops - start_hops;
+        stats->seconds = (double)(end_ns - start_ns) / 1e9;
+    }
 
     // cleanup
     status = channel_close(main_channel);
@@ -129,7 +366,15 @@ void run_stress_send_recv(size_t buffer_size, size_t num_threads, double load, u
         assert(status == SUCCESS);
         status = channel_destroy(channels[i]);
         assert(status == SUCCESS);
+        free(workers[i].backlog);
+    }
+    if (config.payload == SEND_RECV_BOXED) {
+        for (size_t msg = 1; msg <= num_msgs; msg++) {
+            free(messages[msg]);
+        }
     }
+    free(messages);
+    free(workers);
     free(msg_check);
     free(pid);
     free(channels);
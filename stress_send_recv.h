@@ -1,6 +1,57 @@
 #ifndef STRESS_SEND_RECV_H
 #define STRESS_SEND_RECV_H
 
+#include <stddef.h>
+#include <unistd.h>
+
+// How worker threads pass messages to each other
+enum send_recv_topology {
+    // One ring; every worker blocks in send to the next worker and in receive on its own channel
+    SEND_RECV_RING,
+    // num_rings independent rings of consecutive workers
+    SEND_RECV_MULTI_RING,
+    // Every hop goes to a uniformly random other worker
+    SEND_RECV_ALL_TO_ALL,
+    // Workers form a binary tree and every hop goes to a random tree neighbor
+    SEND_RECV_TREE,
+};
+
+// What a message carries
+enum send_recv_payload {
+    // The message id itself, stored in the data pointer
+    SEND_RECV_INLINE,
+    // A pointer to a heap block of payload_size bytes that every hop reads and writes
+    SEND_RECV_BOXED,
+};
+
+typedef struct {
+    size_t buffer_size;
+    size_t num_threads;
+    enum send_recv_topology topology;
+    // Number of rings for SEND_RECV_MULTI_RING; must divide num_threads
+    size_t num_rings;
+    // Messages circulating during the run; 0 derives it from load
+    size_t num_msgs;
+    // Fraction of the ring's total capacity (num_threads * (buffer_size + 1)) to fill when num_msgs is 0
+    double load;
+    enum send_recv_payload payload;
+    size_t payload_size;
+    useconds_t duration_usec;
+} send_recv_config_t;
+
+typedef struct {
+    // Messages passed from one worker to another while the run was timed
+    size_t hops;
+    // Length of the timed run in seconds
+    double seconds;
+} send_recv_stats_t;
+
 void run_stress_send_recv(size_t buffer_size, size_t num_threads, double load, useconds_t duration_usec);
 
+// Circulates messages between worker threads for the configured duration, checks that every message comes back
+// exactly once, and fills in stats (if not NULL) from relaxed per-thread hop counters
+// Topologies other than SEND_RECV_RING forward through channel_select with a local backlog, so they cannot deadlock
+// however the hops line up
+void run_stress_send_recv_config(const send_recv_config_t* config, send_recv_stats_t* stats);
+
 #endif // STRESS_SEND_RECV_H
@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "task_pool.h"
+
+// Task states; a task is in the run queue exactly when it is SCHEDULED
+enum {
+    // Waiting for a channel change
+    TASK_IDLE,
+    // In the run queue
+    TASK_SCHEDULED,
+    // Running on a worker
+    TASK_RUNNING,
+    // Running on a worker and woken since it started, so it must run again before going idle
+    TASK_NOTIFIED,
+};
+
+static void task_run(task_t* task)
+{
+    atomic_store(&task->state, TASK_RUNNING);
+    while (task->run(task->arg) == TASK_BLOCKED) {
+        int running = TASK_RUNNING;
+        if (atomic_compare_exchange_strong(&task->state, &running, TASK_IDLE)) {
+            return;
+        }
+        // woken while running: the change may have come after the task last looked, so look again
+        atomic_store(&task->state, TASK_RUNNING);
+    }
+    // the task may have freed itself, so it is not touched again
+}
+
+static void* task_worker(void* arg)
+{
+    task_pool_t* pool = (task_pool_t*)arg;
+    while (task_pool_run_one(pool) == SUCCESS) {
+    }
+    return NULL;
+}
+
+// Creates a pool of num_workers threads able to hold up to max_tasks tasks
+// With num_workers of 0 the pool has no threads of its own and its tasks only run in task_pool_run_one
+task_pool_t* task_pool_create(size_t num_workers, size_t max_tasks)
+{
+    assert(max_tasks > 0);
+    task_pool_t* pool = malloc(sizeof(task_pool_t));
+    assert(pool != NULL);
+    // a task is queued at most once, so sends to the queue never find it full
+    pool->queue = channel_create(max_tasks);
+    assert(pool->queue != NULL);
+    pool->pid = malloc(sizeof(pthread_t) * num_workers);
+    assert(pool->pid != NULL || num_workers == 0);
+    pool->num_workers = num_workers;
+    for (size_t i = 0; i < num_workers; i++) {
+        int pthread_status = pthread_create(&pool->pid[i], NULL, task_worker, pool);
+        assert(pthread_status == 0);
+    }
+    return pool;
+}
+
+// Stops the workers once the queue is empty and frees the pool
+// Every task must have returned TASK_DONE; the caller still owns the task_t memory
+void task_pool_destroy(task_pool_t* pool)
+{
+    enum channel_status status = channel_close(pool->queue);
+    assert(status == SUCCESS);
+    for (size_t i = 0; i < pool->num_workers; i++) {
+        pthread_join(pool->pid[i], NULL);
+    }
+    status = channel_destroy(pool->queue);
+    assert(status == SUCCESS);
+    free(pool->pid);
+    free(pool);
+}
+
+// Runs the next queued task on the calling thread, waiting while the queue is empty
+// Returns SUCCESS once a task has run, or CLOSED_ERROR once the pool is being destroyed
+enum channel_status task_pool_run_one(task_pool_t* pool)
+{
+    void* data = NULL;
+    enum channel_status status = channel_receive(pool->queue, &data);
+    if (status == SUCCESS) {
+        task_run((task_t*)data);
+    }
+    return status;
+}
+
+// Watch callback; runs with the changed channel's lock held, which only ever nests the run queue's lock inside it
+static void task_notify(void* arg)
+{
+    task_schedule((task_t*)arg);
+}
+
+// Prepares a task that calls run(arg) on the pool's workers; the task does not run until scheduled
+void task_init(task_t* task, task_pool_t* pool, task_fn_t run, void* arg)
+{
+    task->run = run;
+    task->arg = arg;
+    task->pool = pool;
+    atomic_init(&task->state, TASK_IDLE);
+    task->watch.notify = task_notify;
+    task->watch.arg = task;
+}
+
+// Wakes the task whenever the channel changes; the task must unwatch the channel before returning TASK_DONE
+// Returns the channel_watch status
+enum channel_status task_watch(task_t* task, channel_t* channel)
+{
+    return channel_watch(channel, &task->watch);
+}
+
+// Stops waking the task on changes to the channel
+// Returns the channel_unwatch status
+enum channel_status task_unwatch(task_t* task, channel_t* channel)
+{
+    return channel_unwatch(channel, &task->watch);
+}
+
+// Queues the task to run unless it is already queued; if it is running, it runs again when it blocks
+void task_schedule(task_t* task)
+{
+    int state = atomic_load(&task->state);
+    while (true) {
+        if (state == TASK_IDLE) {
+            if (atomic_compare_exchange_weak(&task->state, &state, TASK_SCHEDULED)) {
+                enum channel_status status = channel_non_blocking_send(task->pool->queue, task);
+                assert(status == SUCCESS);
+                return;
+            }
+        } else if (state == TASK_RUNNING) {
+            if (atomic_compare_exchange_weak(&task->state, &state, TASK_NOTIFIED)) {
+                return;
+            }
+        } else {
+            // already queued or already due to run again
+            return;
+        }
+    }
+}
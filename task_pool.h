@@ -0,0 +1,76 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+#ifdef __cplusplus
+// C++ has no stdatomic.h before C++23; std::atomic_int is laid out like the C atomic_int
+#include <atomic>
+typedef std::atomic_int task_state_t;
+extern "C" {
+#else
+#include <stdatomic.h>
+typedef atomic_int task_state_t;
+#endif
+#include "channel.h"
+
+// Result of running a task until it can make no more progress
+enum task_result {
+    // The task is waiting on its channels and should run again when one of them changes
+    TASK_BLOCKED,
+    // The task has finished, has unwatched all of its channels and must never run again
+    // The pool does not touch the task once it returns TASK_DONE, so the task may free itself first
+    TASK_DONE,
+};
+
+// Runs a task's state machine without blocking until it can make no more progress
+typedef enum task_result (*task_fn_t)(void* arg);
+
+// Fixed pool of worker threads running event-driven tasks; the run queue is itself a channel
+typedef struct {
+    channel_t* queue;
+    pthread_t* pid;
+    size_t num_workers;
+} task_pool_t;
+
+// Lightweight task multiplexed on a task pool; woken through channel watches on the channels it waits on
+typedef struct {
+    task_fn_t run;
+    void* arg;
+    task_pool_t* pool;
+    // One of the task states in task_pool.c
+    task_state_t state;
+    channel_watch_t watch;
+} task_t;
+
+// Creates a pool of num_workers threads able to hold up to max_tasks tasks
+// With num_workers of 0 the pool has no threads of its own and its tasks only run in task_pool_run_one
+task_pool_t* task_pool_create(size_t num_workers, size_t max_tasks);
+
+// Stops the workers once the queue is empty and frees the pool
+// Every task must have returned TASK_DONE; the caller still owns the task_t memory
+void task_pool_destroy(task_pool_t* pool);
+
+// Runs the next queued task on the calling thread, waiting while the queue is empty
+// Returns SUCCESS once a task has run, or CLOSED_ERROR once the pool is being destroyed
+enum channel_status task_pool_run_one(task_pool_t* pool);
+
+// Prepares a task that calls run(arg) on the pool's workers; the task does not run until scheduled
+void task_init(task_t* task, task_pool_t* pool, task_fn_t run, void* arg);
+
+// Wakes the task whenever the channel changes; the task must unwatch the channel before returning TASK_DONE
+// Returns the channel_watch status
+enum channel_status task_watch(task_t* task, channel_t* channel);
+
+// Stops waking the task on changes to the channel
+// Returns the channel_unwatch status
+enum channel_status task_unwatch(task_t* task, channel_t* channel);
+
+// Queues the task to run unless it is already queued; if it is running, it runs again when it blocks
+void task_schedule(task_t* task);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_POOL_H
@@ -8,8 +8,13 @@
 #include <sys/resource.h>
 #include <string.h>
 #include <stdbool.h>
+#include "distance.h"
+#include "floyd_warshall.h"
+#include "topology.h"
+#include "topology_gen.h"
 #include "stress.h"
 #include "stress_send_recv.h"
+#include "test_cpp.h"
 
 #define mu_str_(text) #text
 #define mu_str(text) mu_str_(text)
@@ -976,6 +981,89 @@ char* test_select_close() {
     return NULL;
 }
 
+char* test_list_insert_empty() {
+    print_test_details(__func__, "Testing insert into an empty list");
+
+    list_t* list = list_create();
+    int first = 1;
+    int second = 2;
+    list_insert(list, &first);
+    mu_assert("test_list_insert_empty: Count is not 1 after the first insert", list_count(list) == 1);
+    mu_assert("test_list_insert_empty: Head does not hold the inserted data", list_data(list_begin(list)) == &first);
+    mu_assert("test_list_insert_empty: Only node should not link to itself", list_next(list_begin(list)) == NULL);
+    mu_assert("test_list_insert_empty: Only node should have no previous node", list_begin(list)->prev == NULL);
+
+    list_insert(list, &second);
+    mu_assert("test_list_insert_empty: Count is not 2 after the second insert", list_count(list) == 2);
+    mu_assert("test_list_insert_empty: Second node is not linked back to the head", list_next(list_begin(list))->prev == list_begin(list));
+
+    list_remove(list, list_find(list, &first));
+    list_remove(list, list_find(list, &second));
+    mu_assert("test_list_insert_empty: List is not empty after removing every node", list_count(list) == 0 && list_begin(list) == NULL);
+    list_insert(list, &first);
+    mu_assert("test_list_insert_empty: Insert into an emptied list failed", list_count(list) == 1 && list_next(list_begin(list)) == NULL);
+    list_destroy(list);
+    return NULL;
+}
+
+char* test_select_receive_data() {
+    print_test_details(__func__, "Testing that select hands received data back through select_t.data");
+
+    size_t CHANNELS = 3;
+    channel_t* channel[CHANNELS];
+    select_t list[CHANNELS];
+    for (size_t i = 0; i < CHANNELS; i++) {
+        channel[i] = channel_create(1);
+        list[i].channel = channel[i];
+        list[i].dir = RECV;
+        list[i].data = NULL;
+    }
+
+    mu_assert("test_select_receive_data: Send failed", channel_send(channel[2], "Message") == SUCCESS);
+    size_t index = CHANNELS;
+    mu_assert("test_select_receive_data: Select failed", channel_select(list, CHANNELS, &index) == SUCCESS);
+    mu_assert("test_select_receive_data: Wrong selected index", index == 2);
+    mu_assert("test_select_receive_data: Received data is not in select_t.data", string_equal(list[2].data, "Message"));
+    mu_assert("test_select_receive_data: Select left data in the channel", buffer_current_size(channel[2]->buffer) == 0);
+
+    for (size_t i = 0; i < CHANNELS; i++) {
+        mu_assert("test_select_receive_data: Select left a registration behind", list_count(channel[i]->select) == 0);
+        channel_close(channel[i]);
+        channel_destroy(channel[i]);
+    }
+    return NULL;
+}
+
+char* test_select_closed_registration() {
+    print_test_details(__func__, "Testing select on a closed channel that follows open ones");
+
+    size_t CHANNELS = 3;
+    channel_t* channel[CHANNELS];
+    select_t list[CHANNELS];
+    for (size_t i = 0; i < CHANNELS; i++) {
+        channel[i] = channel_create(1);
+        list[i].channel = channel[i];
+        list[i].dir = RECV;
+        list[i].data = NULL;
+    }
+
+    mu_assert("test_select_closed_registration: Can't close channel", channel_close(channel[2]) == SUCCESS);
+    size_t index = CHANNELS;
+    mu_assert("test_select_closed_registration: Select should return CLOSED_ERROR", channel_select(list, CHANNELS, &index) == CLOSED_ERROR);
+    mu_assert("test_select_closed_registration: Index of the closed channel was not reported", index == 2);
+    for (size_t i = 0; i < 2; i++) {
+        mu_assert("test_select_closed_registration: Registration on an earlier channel was not removed", list_count(channel[i]->select) == 0);
+    }
+
+    for (size_t i = 0; i < CHANNELS; i++) {
+        if (i != 2) {
+            channel_close(channel[i]);
+        }
+        channel_destroy(channel[i]);
+    }
+    return NULL;
+}
+
 char* test_cpu_utilization_send() {
     print_test_details(__func__, "Testing CPU utilization for send API (takes around 30 seconds)");
 
@@ -1281,6 +1369,179 @@ char* test_non_blocking_unbuffered() {
     
 }
 
+char* test_distance_min_plus() {
+    print_test_details(__func__, "Testing the distance vector min-plus kernels");
+
+    /* Compare every kernel this CPU supports, and the dispatched one, against a scalar reference over
+     * every tail length, with unreachable entries and sums that must saturate at inf_distance
+     */
+    size_t num_variants = 0;
+    const distance_min_plus_variant_t* variants = distance_min_plus_variants(&num_variants);
+    mu_assert("test_distance_min_plus: No kernel is available\n", num_variants > 0);
+    distance_t dst[67];
+    distance_t src[67];
+    distance_t expected[67];
+    for (size_t v = 0; v <= num_variants; v++) {
+        // the last pass goes through distance_min_plus itself
+        bool (*min_plus)(distance_t*, const distance_t*, distance_t, size_t) = v < num_variants ? variants[v].min_plus : distance_min_plus;
+        unsigned int seed = 1;
+        for (size_t count = 0; count <= 67; count++) {
+            for (int round = 0; round < 20; round++) {
+                distance_t offset = (round % 5 == 0) ? inf_distance - 1 : (distance_t)(rand_r(&seed) % 100);
+                for (size_t i = 0; i < count; i++) {
+                    src[i] = (rand_r(&seed) % 4 == 0) ? inf_distance : (distance_t)(rand_r(&seed) % 200);
+                    dst[i] = (rand_r(&seed) % 4 == 0) ? inf_distance : (distance_t)(rand_r(&seed) % 200);
+                }
+                bool expected_changed = false;
+                for (size_t i = 0; i < count; i++) {
+                    distance_t sum = offset + src[i] > inf_distance ? inf_distance : offset + src[i];
+                    expected[i] = sum < dst[i] ? sum : dst[i];
+                    expected_changed = expected_changed || expected[i] != dst[i];
+                }
+                bool changed = min_plus(dst, src, offset, count);
+                mu_assert("test_distance_min_plus: Changed flag is not as expected\n", changed == expected_changed);
+                for (size_t i = 0; i < count; i++) {
+                    mu_assert("test_distance_min_plus: Merged distance is not as expected\n", dst[i] == expected[i]);
+                }
+                // merging the same vector again must be a no-op
+                mu_assert("test_distance_min_plus: Repeated merge reported a change\n", !min_plus(dst, src, offset, count));
+            }
+        }
+    }
+    return NULL;
+}
+
+char* test_floyd_warshall() {
+    print_test_details(__func__, "Testing the blocked parallel Floyd-Warshall solver");
+
+    /* Compare against the textbook triple loop on sizes around the tile boundary,
+     * solved inline and on a pool of tile workers
+     */
+    size_t sizes[] = {1, 2, FLOYD_WARSHALL_BLOCK - 1, FLOYD_WARSHALL_BLOCK, FLOYD_WARSHALL_BLOCK + 1, 3 * FLOYD_WARSHALL_BLOCK + 7};
+    size_t threads[] = {1, 4};
+    unsigned int seed = 1;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t count = sizes[s];
+        distance_t* expected = malloc(sizeof(distance_t) * count * count);
+        distance_t* solution = malloc(sizeof(distance_t) * count * count);
+        mu_assert("test_floyd_warshall: Could not allocate matrices\n", expected != NULL && solution != NULL);
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            for (size_t i = 0; i < count * count; i++) {
+                expected[i] = (rand_r(&seed) % 8 == 0) ? (distance_t)(rand_r(&seed) % 100) : inf_distance;
+            }
+            for (size_t i = 0; i < count; i++) {
+                expected[i * count + i] = 0;
+            }
+            memcpy(solution, expected, sizeof(distance_t) * count * count);
+            floyd_warshall_reference(expected, count);
+            floyd_warshall(solution, count, threads[t]);
+            mu_assert("test_floyd_warshall: Shortest path distance is not as expected\n", memcmp(solution, expected, sizeof(distance_t) * count * count) == 0);
+        }
+        free(expected);
+        free(solution);
+    }
+    return NULL;
+}
+
+char* test_topology_load() {
+    print_test_details(__func__, "Testing the text and binary topology loaders");
+
+    /* Load every bundled topology from text, convert it to binary and back, and check that all three
+     * agree with each other and with a plain fscanf reading of the matrix
+     */
+    const char* files[] = {"topology.txt", "connected_topology.txt", "random_topology.txt", "random_topology_1.txt", "big_graph.txt"};
+    for (size_t f = 0; f < sizeof(files) / sizeof(files[0]); f++) {
+        FILE* file = fopen(files[f], "r");
+        mu_assert("test_topology_load: Could not open topology file\n", file != NULL);
+        size_t count = 0;
+        mu_assert("test_topology_load: Could not read node count\n", fscanf(file, "%zu", &count) == 1);
+        distance_t* expected = malloc(sizeof(distance_t) * count * count);
+        distance_t* matrix = malloc(sizeof(distance_t) * count * count);
+        mu_assert("test_topology_load: Could not allocate matrices\n", expected != NULL && matrix != NULL);
+        for (size_t i = 0; i < count * count; i++) {
+            int distance;
+            mu_assert("test_topology_load: Could not read link distance\n", fscanf(file, "%d", &distance) == 1);
+            expected[i] = distance < 0 ? inf_distance : (distance_t)distance;
+        }
+        fclose(file);
+
+        char binary[] = "/tmp/topology_XXXXXX";
+        char text[] = "/tmp/topology_XXXXXX";
+        int fd = mkstemp(binary);
+        mu_assert("test_topology_load: Could not create temporary file\n", fd >= 0);
+        close(fd);
+        fd = mkstemp(text);
+        mu_assert("test_topology_load: Could not create temporary file\n", fd >= 0);
+        close(fd);
+
+        topology_t* topology = topology_load(files[f]);
+        mu_assert("test_topology_load: Could not load text topology\n", topology != NULL && topology->num_nodes == count);
+        mu_assert("test_topology_load: Could not save binary topology\n", topology_save_binary(topology, binary));
+        topology_destroy(topology);
+        topology = topology_load(binary);
+        mu_assert("test_topology_load: Could not load binary topology\n", topology != NULL && topology->num_nodes == count);
+        mu_assert("test_topology_load: Binary topology is not mapped in place\n", topology->mapping != NULL);
+        mu_assert("test_topology_load: Could not save text topology\n", topology_save_text(topology, text));
+        for (size_t src = 0; src < count; src++) {
+            for (size_t dst = 0; dst < count; dst++) {
+                mu_assert("test_topology_load: Link distance is not as expected\n", topology_link_distance(topology, src, dst) == expected[src * count + dst]);
+            }
+        }
+        topology_destroy(topology);
+        topology = topology_load(text);
+        mu_assert("test_topology_load: Could not reload text topology\n", topology != NULL && topology->num_nodes == count);
+        topology_to_matrix(topology, matrix);
+        mu_assert("test_topology_load: Link matrix is not as expected\n", memcmp(matrix, expected, sizeof(distance_t) * count * count) == 0);
+        topology_destroy(topology);
+
+        unlink(binary);
+        unlink(text);
+        free(expected);
+        free(matrix);
+    }
+    mu_assert("test_topology_load: Loaded a missing topology file\n", topology_load("missing_topology.txt") == NULL);
+    return NULL;
+}
+
+char* test_topology_generate() {
+    print_test_details(__func__, "Testing the synthetic topology generator");
+
+    /* Every family must produce a symmetric, loop-free topology with the expected link count that is the same
+     * for the same seed, and the routers must converge on it
+     */
+    enum topology_family families[] = {TOPOLOGY_RING, TOPOLOGY_GRID, TOPOLOGY_ERDOS_RENYI, TOPOLOGY_SCALE_FREE, TOPOLOGY_HUB};
+    size_t num_nodes = 25;
+    size_t expected_links[] = {25, 40, 100, 0, 24};
+    for (size_t f = 0; f < sizeof(families) / sizeof(families[0]); f++) {
+        topology_t* topology = topology_generate(families[f], num_nodes, 4 * num_nodes, 5, 7);
+        topology_t* again = topology_generate(families[f], num_nodes, 4 * num_nodes, 5, 7);
+        mu_assert("test_topology_generate: Wrong number of nodes\n", topology->num_nodes == num_nodes);
+        if (expected_links[f] != 0) {
+            mu_assert("test_topology_generate: Wrong number of links\n", topology->num_edges == 2 * expected_links[f]);
+        }
+        mu_assert("test_topology_generate: Same seed gave a different topology\n", again->num_edges == topology->num_edges &&
+                  memcmp(again->offsets, topology->offsets, sizeof(uint64_t) * (num_nodes + 1)) == 0 &&
+                  memcmp(again->targets, topology->targets, sizeof(uint32_t) * topology->num_edges) == 0 &&
+                  memcmp(again->weights, topology->weights, sizeof(distance_t) * topology->num_edges) == 0);
+        for (size_t src = 0; src < num_nodes; src++) {
+            for (uint64_t link = topology->offsets[src]; link < topology->offsets[src + 1]; link++) {
+                size_t dst = topology->targets[link];
+                mu_assert("test_topology_generate: Self link\n", dst != src);
+                mu_assert("test_topology_generate: Weight out of range\n", topology->weights[link] >= 1 && topology->weights[link] <= 5);
+                mu_assert("test_topology_generate: Link is not symmetric\n", topology_link_distance(topology, dst, src) == topology->weights[link]);
+            }
+        }
+        stress_stats_t stats;
+        run_stress_topology(1, 1, topology, 0, &stats);
+        mu_assert("test_topology_generate: Routers exchanged no distance vectors\n", stats.messages > 0);
+        topology_destroy(topology);
+        topology_destroy(again);
+    }
+    mu_assert("test_topology_generate: Family names do not round trip\n", topology_family_parse("ba") == TOPOLOGY_SCALE_FREE &&
+              strcmp(topology_family_name(TOPOLOGY_HUB), "hub") == 0 && topology_family_parse("tree") == -1);
+    return NULL;
+}
+
 char* test_stress_buffered() {
     print_test_details(__func__, "Stress Testing for buffered channels");
     run_stress(1, 1, "topology.txt");
@@ -1291,6 +1552,42 @@ char* test_stress_buffered() {
     return NULL;
 }
 
+char* test_stress_large_buffers() {
+    print_test_details(__func__, "Stress Testing for channels buffering several distance vectors");
+    run_stress(4, 4, "topology.txt");
+    run_stress(4, 4, "connected_topology.txt");
+    run_stress(16, 2, "random_topology.txt");
+    run_stress(16, 2, "random_topology_1.txt");
+    run_stress(64, 16, "big_graph.txt");
+    topology_t* topology = topology_load("big_graph.txt");
+    mu_assert("test_stress_large_buffers: Could not load topology\n", topology != NULL);
+    stress_stats_t stats;
+    run_stress_topology(16, 4, topology, 2, &stats);
+    mu_assert("test_stress_large_buffers: Routers exchanged no distance vectors\n", stats.messages > 0);
+    mu_assert("test_stress_large_buffers: Routers never woke up\n", stats.wakeups > 0);
+    topology_destroy(topology);
+    return NULL;
+}
+
+char* test_stress_task_pool() {
+    print_test_details(__func__, "Stress Testing routers multiplexed on a task pool");
+
+    /* Run the routers as watch-driven tasks on pools smaller than, equal to and larger than the CPU count */
+    const char* files[] = {"topology.txt", "connected_topology.txt", "random_topology.txt", "random_topology_1.txt", "big_graph.txt"};
+    size_t workers[] = {1, 2, 8};
+    for (size_t f = 0; f < sizeof(files) / sizeof(files[0]); f++) {
+        topology_t* topology = topology_load(files[f]);
+        mu_assert("test_stress_task_pool: Could not load topology\n", topology != NULL);
+        for (size_t w = 0; w < sizeof(workers) / sizeof(workers[0]); w++) {
+            stress_stats_t stats;
+            run_stress_topology(1, 1, topology, workers[w], &stats);
+            mu_assert("test_stress_task_pool: Routers exchanged no distance vectors\n", stats.messages > 0);
+        }
+        topology_destroy(topology);
+    }
+    return NULL;
+}
+
 char* test_stress_unbuffered() {
     print_test_details(__func__, "Stress Testing for unbuffered channels");
     run_stress(0, 0, "topology.txt");
@@ -1322,6 +1619,31 @@ char* test_stress_send_recv_buffered() {
     return NULL;
 }
 
+char* test_stress_send_recv_topologies() {
+    print_test_details(__func__, "Stress Testing send/recv over rings, all-to-all and tree topologies (takes around 3 seconds)");
+    enum send_recv_topology topologies[] = {SEND_RECV_MULTI_RING, SEND_RECV_ALL_TO_ALL, SEND_RECV_TREE};
+    for (size_t t = 0; t < sizeof(topologies) / sizeof(topologies[0]); t++) {
+        for (size_t boxed = 0; boxed <= 1; boxed++) {
+            send_recv_config_t config = {
+                .buffer_size = 1 + 3 * boxed,
+                .num_threads = 8,
+                .topology = topologies[t],
+                .num_rings = 2,
+                .num_msgs = 0,
+                .load = 0.75,
+                .payload = boxed ? SEND_RECV_BOXED : SEND_RECV_INLINE,
+                .payload_size = boxed ? 256 : 0,
+                .duration_usec = 500000,
+            };
+            send_recv_stats_t stats;
+            run_stress_send_recv_config(&config, &stats);
+            mu_assert("test_stress_send_recv_topologies: No message was passed between threads\n", stats.hops > 0);
+            mu_assert("test_stress_send_recv_topologies: Run was not timed\n", stats.seconds > 0);
+        }
+    }
+    return NULL;
+}
+
 char* test_stress_send_recv_unbuffered() {
     print_test_details(__func__, "Stress Testing send/recv for unbuffered version (takes around 10 seconds)");
     run_stress_send_recv(0, 4, 0.25, 2000000);
@@ -2020,6 +2342,116 @@ char* test_select_mixed_buffered_unbuffered() {
     return NULL;
 }
 
+// Allocator hook context counting the blocks handed out and returned
+typedef struct {
+    pthread_mutex_t mutex;
+    size_t allocs;
+    size_t frees;
+    size_t live_bytes;
+    // When non-zero, allocations fail once this many blocks have been handed out
+    size_t limit;
+} counting_allocator_t;
+
+static void* counting_alloc(void* context, size_t size) {
+    counting_allocator_t* counter = (counting_allocator_t*)context;
+    pthread_mutex_lock(&counter->mutex);
+    if (counter->limit != 0 && counter->allocs == counter->limit) {
+        pthread_mutex_unlock(&counter->mutex);
+        return NULL;
+    }
+    counter->allocs++;
+    counter->live_bytes += size;
+    pthread_mutex_unlock(&counter->mutex);
+    return malloc(size);
+}
+
+static void counting_free(void* context, void* ptr, size_t size) {
+    counting_allocator_t* counter = (counting_allocator_t*)context;
+    pthread_mutex_lock(&counter->mutex);
+    counter->frees++;
+    counter->live_bytes -= size;
+    pthread_mutex_unlock(&counter->mutex);
+    free(ptr);
+}
+
+char* test_channel_allocator() {
+    print_test_details(__func__, "Testing channels created with an allocator hook");
+    counting_allocator_t counter = {.allocs = 0, .frees = 0, .live_bytes = 0, .limit = 0};
+    pthread_mutex_init(&counter.mutex, NULL);
+    channel_allocator_t allocator = {counting_alloc, counting_free, &counter};
+
+    /* The channel and its buffer come from the hook */
+    channel_t* channel = channel_create_with_allocator(2, &allocator);
+    mu_assert("test_channel_allocator: Channel was not allocated from the hook", counter.allocs > 0);
+    mu_assert("test_channel_allocator: Buffer was not allocated from the hook", counter.live_bytes >= sizeof(channel_t) + 2 * sizeof(void*));
+    size_t created = counter.allocs;
+    mu_assert("test_channel_allocator: Send failed", channel_send(channel, "Message1") == SUCCESS);
+    void* data = NULL;
+    mu_assert("test_channel_allocator: Receive failed", channel_receive(channel, &data) == SUCCESS);
+    mu_assert("test_channel_allocator: Received wrong message", string_equal(data, "Message1"));
+    mu_assert("test_channel_allocator: Send and receive allocated", counter.allocs == created);
+
+    /* A blocked select registers on the channel through the hook */
+    select_t list[1] = {{channel, RECV, NULL}};
+    select_args args;
+    pthread_t pid;
+    init_object_for_select_api(&args, list, 1, NULL);
+    pthread_create(&pid, NULL, (void *)helper_select, &args);
+    usleep(10000);
+    mu_assert("test_channel_allocator: Send failed", channel_send(channel, "Message2") == SUCCESS);
+    pthread_join(pid, NULL);
+    mu_assert("test_channel_allocator: Select failed", args.out == SUCCESS);
+    mu_assert("test_channel_allocator: Received wrong message", string_equal(list[0].data, "Message2"));
+    mu_assert("test_channel_allocator: Select did not allocate from the hook", counter.allocs > created);
+
+    /* Everything goes back to the hook on destroy */
+    channel_close(channel);
+    channel_destroy(channel);
+    mu_assert("test_channel_allocator: Blocks were not freed", counter.frees == counter.allocs);
+    mu_assert("test_channel_allocator: Bytes were not freed", counter.live_bytes == 0);
+
+    /* A NULL allocator behaves as channel_create */
+    channel = channel_create_with_allocator(1, NULL);
+    mu_assert("test_channel_allocator: Send failed", channel_send(channel, "Message3") == SUCCESS);
+    mu_assert("test_channel_allocator: Receive failed", channel_receive(channel, &data) == SUCCESS);
+    channel_close(channel);
+    channel_destroy(channel);
+
+    /* An allocator that runs out at any point fails the create and gets every block back */
+    for (size_t limit = 1; limit < created; limit++) {
+        counter.allocs = 0;
+        counter.frees = 0;
+        counter.limit = limit;
+        mu_assert("test_channel_allocator: Create succeeded without memory", channel_create_with_allocator(2, &allocator) == NULL);
+        mu_assert("test_channel_allocator: Failed create did not free its blocks", counter.frees == counter.allocs);
+        mu_assert("test_channel_allocator: Failed create did not free its bytes", counter.live_bytes == 0);
+    }
+
+    /* Once the allocator is exhausted, selects and watches that need a list node fail instead of crashing */
+    counter.allocs = 0;
+    counter.frees = 0;
+    counter.limit = created;
+    channel = channel_create_with_allocator(1, &allocator);
+    mu_assert("test_channel_allocator: Create failed with exactly enough memory", channel != NULL);
+    channel_t* open_channel = channel_create(1);
+    select_t blocked[2] = {{open_channel, RECV, NULL}, {channel, RECV, NULL}};
+    size_t index = 0;
+    mu_assert("test_channel_allocator: Select without memory did not return GEN_ERROR", channel_select(blocked, 2, &index) == GEN_ERROR);
+    mu_assert("test_channel_allocator: Select without memory reported the wrong index", index == 1);
+    mu_assert("test_channel_allocator: Failed select left a registration behind", list_count(open_channel->select) == 0);
+    channel_watch_t watch = {NULL, NULL};
+    mu_assert("test_channel_allocator: Watch without memory did not return GEN_ERROR", channel_watch(channel, &watch) == GEN_ERROR);
+    mu_assert("test_channel_allocator: Send without memory failed", channel_send(channel, "Message4") == SUCCESS);
+    mu_assert("test_channel_allocator: Receive without memory failed", channel_receive(channel, &data) == SUCCESS && string_equal(data, "Message4"));
+    channel_close(open_channel);
+    channel_destroy(open_channel);
+    channel_close(channel);
+    channel_destroy(channel);
+    mu_assert("test_channel_allocator: Bytes were not freed", counter.live_bytes == 0);
+    pthread_mutex_destroy(&counter.mutex);
+    return NULL;
+}
+
 typedef char* (*test_fn_t)();
 typedef struct {
     char* name;
@@ -2035,6 +2467,7 @@ test_t tests[] = {{"test_initialization", test_initialization},
                   {"test_multiple_channels", test_multiple_channels},
                   {"test_overall_send_receive", test_overall_send_receive},
                   {"test_stress_send_recv_buffered", test_stress_send_recv_buffered},
+                  {"test_stress_send_recv_topologies", test_stress_send_recv_topologies},
                   {"test_response_time", test_response_time},
                   {"test_cpu_utilization_send", test_cpu_utilization_send},
                   {"test_cpu_utilization_receive", test_cpu_utilization_receive},
@@ -2042,13 +2475,28 @@ test_t tests[] = {{"test_initialization", test_initialization},
                   {"test_channel_close_with_receive", test_channel_close_with_receive},
                   {"test_select", test_select},
                   {"test_select_close", test_select_close},
+                  {"test_list_insert_empty", test_list_insert_empty},
+                  {"test_select_receive_data", test_select_receive_data},
+                  {"test_select_closed_registration", test_select_closed_registration},
                   {"test_select_and_non_blocking_send_buffered", test_select_and_non_blocking_send_buffered},
                   {"test_select_and_non_blocking_receive_buffered", test_select_and_non_blocking_receive_buffered},
                   {"test_select_with_select_buffered", test_select_with_select_buffered},
                   {"test_select_with_same_channel_buffered", test_select_with_same_channel_buffered},
                   {"test_select_with_send_receive_on_same_channel_buffered", test_select_with_send_receive_on_same_channel_buffered},
                   {"test_select_with_duplicate_channel_buffered", test_select_with_duplicate_channel_buffered},
+                  {"test_channel_allocator", test_channel_allocator},
+                  {"test_distance_min_plus", test_distance_min_plus},
+                  {"test_floyd_warshall", test_floyd_warshall},
+                  {"test_topology_load", test_topology_load},
+                  {"test_topology_generate", test_topology_generate},
                   {"test_stress_buffered", test_stress_buffered},
+                  {"test_stress_task_pool", test_stress_task_pool},
+                  {"test_stress_large_buffers", test_stress_large_buffers},
+                  {"test_cpp_channel", test_cpp_channel},
+                  {"test_cpp_coroutines", test_cpp_coroutines},
+                  {"test_cpp_select", test_cpp_select},
+                  {"test_cpp_policy", test_cpp_policy},
+                  {"test_cpp_allocator", test_cpp_allocator},
                   {"test_select_response_time", test_select_response_time},
                   {"test_cpu_utilization_select", test_cpu_utilization_select},
                   {"test_cpu_utilization_overall", test_cpu_utilization_overall},
@@ -0,0 +1,642 @@
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "channel.hpp"
+#include "channel_coro.hpp"
+#include "channel_policy.hpp"
+#include "test_cpp.h"
+
+#define mu_str_(text) #text
+#define mu_str(text) mu_str_(text)
+#define mu_assert(message, test) do { if (!(test)) return const_cast<char*>("FAILURE: See " __FILE__ " Line " mu_str(__LINE__) ": " message); } while (0)
+
+extern "C" void print_test_details(const char* test_name, const char* message);
+
+namespace {
+
+// Counts live instances, so the test can check that every message constructed is destroyed exactly once
+struct Tracked {
+    static int live;
+    int value;
+
+    explicit Tracked(int value) : value(value)
+    {
+        live++;
+    }
+    Tracked(Tracked&& other) noexcept : value(other.value)
+    {
+        live++;
+    }
+    Tracked& operator=(Tracked&& other) noexcept
+    {
+        value = other.value;
+        return *this;
+    }
+    ~Tracked()
+    {
+        live--;
+    }
+};
+
+int Tracked::live = 0;
+
+// Message whose move constructor throws while throw_on_move is set
+struct ThrowingMove {
+    static bool throw_on_move;
+    int value;
+
+    explicit ThrowingMove(int value) : value(value) {}
+    ThrowingMove(ThrowingMove&& other) : value(other.value)
+    {
+        if (throw_on_move) {
+            throw std::runtime_error("move");
+        }
+    }
+};
+
+bool ThrowingMove::throw_on_move = false;
+
+// Sends 1..count, then 0 to mark the end (closing would drop messages still buffered)
+chan::Task produce(chan::Channel<int>& out, int count)
+{
+    for (int i = 1; i <= count; i++) {
+        co_await chan::async_send(out, i);
+    }
+    co_await chan::async_send(out, 0);
+}
+
+// Forwards every message plus one, and then the end mark
+chan::Task stage(chan::Channel<int>& in, chan::Channel<int>& out)
+{
+    while (true) {
+        std::optional<int> value = co_await chan::async_receive(in);
+        if (!value || *value == 0) {
+            break;
+        }
+        co_await chan::async_send(out, *value + 1);
+    }
+    co_await chan::async_send(out, 0);
+}
+
+// Adds up every message until the end mark
+chan::Task consume(chan::Channel<int>& in, long& sum)
+{
+    while (true) {
+        std::optional<int> value = co_await chan::async_receive(in);
+        if (!value || *value == 0) {
+            break;
+        }
+        sum += *value;
+    }
+}
+
+// Receives expected messages from whichever of two channels is ready, adding up the messages from each
+chan::Task merge(chan::Channel<int>& first, chan::Channel<int>& second, int expected, int* sums)
+{
+    select_t list[2] = {first.select_recv(), second.select_recv()};
+    for (int i = 0; i < expected; i++) {
+        auto [status, index] = co_await chan::async_select(list, 2);
+        if (status != SUCCESS) {
+            break;
+        }
+        sums[index] += (index == 0 ? first : second).finish_recv(list[index]);
+    }
+}
+
+// Typed select version of merge: adds up messages from either channel until it has seen expected of them
+chan::Task merge_cases(chan::Channel<int>& first, chan::Channel<std::string>& second, int expected, long& sum)
+{
+    for (int i = 0; i < expected; i++) {
+        auto [status, index] = co_await chan::async_select(chan::on_recv(first, [&sum](int value) { sum += value; }),
+                                                           chan::on_recv(second, [&sum](std::string value) { sum += std::stol(value); }));
+        (void)index;
+        if (status != SUCCESS) {
+            break;
+        }
+    }
+}
+
+// Waits on a channel nobody sends on, recording whether it saw the channel close
+chan::Task wait_for_close(chan::Channel<int>& in, bool& closed)
+{
+    std::optional<int> value = co_await chan::async_receive(in);
+    closed = !value;
+}
+
+// Receives once, recording whether a message came back
+chan::Task receive_once(chan::Channel<int>& in, bool& received)
+{
+    std::optional<int> value = co_await chan::async_receive(in);
+    received = value.has_value();
+}
+
+// Selects once on a receive case, recording the status
+chan::Task select_once(chan::Channel<int>& in, enum channel_status& status)
+{
+    auto [result, index] = co_await chan::async_select(chan::on_recv(in, [](int) {}));
+    (void)index;
+    status = result;
+}
+
+// Runs a pipeline of num_stages actors over channels of the given capacity and returns the sum the consumer saw
+template <typename Executor>
+long run_pipeline(Executor& executor, size_t num_stages, size_t capacity, int count)
+{
+    std::vector<std::unique_ptr<chan::Channel<int>>> channels;
+    for (size_t i = 0; i <= num_stages; i++) {
+        channels.push_back(std::make_unique<chan::Channel<int>>(capacity));
+    }
+    long sum = 0;
+    executor.spawn(produce(*channels[0], count));
+    for (size_t i = 0; i < num_stages; i++) {
+        executor.spawn(stage(*channels[i], *channels[i + 1]));
+    }
+    executor.spawn(consume(*channels[num_stages], sum));
+    if constexpr (std::is_same_v<Executor, chan::SingleThreadExecutor>) {
+        executor.run();
+    } else {
+        executor.wait();
+    }
+    return sum;
+}
+
+// Passes messages from several producers to several consumers through a policy channel
+// Returns NULL if every message arrived exactly once, and an error message otherwise
+template <typename Backend, typename Wait, typename Lock, typename... Args>
+const char* check_policy(Args... args)
+{
+    using Channel = chan::policy::Channel<size_t, Backend, Wait, Lock>;
+    Channel channel(args...);
+    const size_t num_threads = 3;
+    const size_t per_thread = 3000;
+    std::atomic<size_t> received(0);
+    std::atomic<size_t> checksum(0);
+    std::vector<std::thread> producers;
+    std::vector<std::thread> consumers;
+    for (size_t t = 0; t < num_threads; t++) {
+        producers.emplace_back([&channel, t] {
+            for (size_t i = 0; i < per_thread; i++) {
+                channel.send(t * per_thread + i + 1);
+            }
+        });
+        consumers.emplace_back([&channel, &received, &checksum] {
+            while (std::optional<size_t> value = channel.receive()) {
+                checksum += *value;
+                received++;
+            }
+        });
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    // closing drops buffered messages, so wait for the consumers to drain the channel first
+    while (received < num_threads * per_thread) {
+        std::this_thread::yield();
+    }
+    if (channel.close() != SUCCESS || channel.close() != CLOSED_ERROR) {
+        return "close did not return SUCCESS and then CLOSED_ERROR";
+    }
+    for (std::thread& consumer : consumers) {
+        consumer.join();
+    }
+    size_t total = num_threads * per_thread;
+    if (checksum != total * (total + 1) / 2) {
+        return "messages were lost or duplicated";
+    }
+    size_t value = 0;
+    if (channel.send(1) != CLOSED_ERROR || channel.try_receive(value) != CLOSED_ERROR) {
+        return "operations on a closed channel did not return CLOSED_ERROR";
+    }
+    return NULL;
+}
+
+// check_policy with every lock policy
+template <typename Backend, typename Wait, typename... Args>
+const char* check_locks(Args... args)
+{
+    const char* error = check_policy<Backend, Wait, chan::policy::MutexLock>(args...);
+    if (error == NULL) {
+        error = check_policy<Backend, Wait, chan::policy::SpinLock>(args...);
+    }
+    if (error == NULL) {
+        error = check_policy<Backend, Wait, chan::policy::TicketLock>(args...);
+    }
+    if (error == NULL) {
+        error = check_policy<Backend, Wait, chan::policy::McsLock>(args...);
+    }
+    return error;
+}
+
+// Memory resource counting what passes through it to an upstream resource
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> live_bytes{0};
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        void* ptr = upstream_->allocate(bytes, alignment);
+        allocations++;
+        live_bytes += bytes;
+        return ptr;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+    {
+        live_bytes -= bytes;
+        upstream_->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+};
+
+} // namespace
+
+char* test_cpp_channel()
+{
+    print_test_details(__func__, "Testing the C++ Channel<T> and Channel<T, N> front-end");
+
+    /* Move-only messages go through a fixed capacity channel without copies */
+    {
+        chan::Channel<std::unique_ptr<int>, 2> channel;
+        mu_assert("test_cpp_channel: Capacity is not N\n", channel.capacity() == 2);
+        mu_assert("test_cpp_channel: Send failed\n", channel.send(std::make_unique<int>(1)) == SUCCESS);
+        mu_assert("test_cpp_channel: Emplace failed\n", channel.emplace(new int(2)) == SUCCESS);
+        mu_assert("test_cpp_channel: Send on a full channel did not return CHANNEL_FULL\n",
+                  channel.try_send(std::make_unique<int>(3)) == CHANNEL_FULL);
+        std::optional<std::unique_ptr<int>> first = channel.receive();
+        mu_assert("test_cpp_channel: Wrong first message\n", first && **first == 1);
+        std::unique_ptr<int> second;
+        mu_assert("test_cpp_channel: Receive failed\n", channel.try_receive(second) == SUCCESS && *second == 2);
+        mu_assert("test_cpp_channel: Receive on an empty channel did not return CHANNEL_EMPTY\n",
+                  channel.try_receive(second) == CHANNEL_EMPTY && *second == 2);
+    }
+
+    /* Messages left in a channel are destroyed with it, and closing wakes receivers */
+    {
+        chan::Channel<Tracked> channel(4);
+        channel.emplace(1);
+        channel.emplace(2);
+        mu_assert("test_cpp_channel: Messages were copied or lost\n", Tracked::live == 2);
+        mu_assert("test_cpp_channel: Close failed\n", channel.close() == SUCCESS);
+        mu_assert("test_cpp_channel: Second close did not return CLOSED_ERROR\n", channel.close() == CLOSED_ERROR);
+        mu_assert("test_cpp_channel: Send on a closed channel did not return CLOSED_ERROR\n", channel.emplace(3) == CLOSED_ERROR);
+        mu_assert("test_cpp_channel: Receive on a closed channel returned a message\n", !channel.receive());
+    }
+    mu_assert("test_cpp_channel: Messages left in the channel were not destroyed\n", Tracked::live == 0);
+
+    /* A message whose move throws on receive still gives its slot back */
+    {
+        chan::Channel<ThrowingMove, 1> channel;
+        mu_assert("test_cpp_channel: Emplace failed\n", channel.emplace(1) == SUCCESS);
+        ThrowingMove::throw_on_move = true;
+        bool thrown = false;
+        try {
+            channel.receive();
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ThrowingMove::throw_on_move = false;
+        mu_assert("test_cpp_channel: Throwing move did not propagate\n", thrown);
+        mu_assert("test_cpp_channel: Slot was not returned after a throwing move\n", channel.try_emplace(2) == SUCCESS);
+        std::optional<ThrowingMove> message = channel.receive();
+        mu_assert("test_cpp_channel: Wrong message after a throwing move\n", message && message->value == 2);
+    }
+
+    /* Producers and consumers pass every message exactly once */
+    {
+        chan::Channel<std::string> channel(3);
+        const int num_threads = 4;
+        const int per_thread = 2000;
+        std::vector<std::thread> producers;
+        std::vector<std::thread> consumers;
+        std::atomic<int> received(0);
+        std::atomic<long> checksum(0);
+        for (int t = 0; t < num_threads; t++) {
+            producers.emplace_back([&channel, t] {
+                for (int i = 0; i < per_thread; i++) {
+                    channel.send(std::to_string(t * per_thread + i));
+                }
+            });
+            consumers.emplace_back([&channel, &received, &checksum] {
+                std::string message;
+                while (channel.receive(message) == SUCCESS) {
+                    checksum += std::stol(message);
+                    received++;
+                }
+            });
+        }
+        for (std::thread& producer : producers) {
+            producer.join();
+        }
+        // closing drops buffered messages, so wait for the consumers to drain the channel first
+        while (received < num_threads * per_thread) {
+            std::this_thread::yield();
+        }
+        channel.close();
+        for (std::thread& consumer : consumers) {
+            consumer.join();
+        }
+        long total = (long)num_threads * per_thread;
+        mu_assert("test_cpp_channel: Messages were lost or duplicated\n", checksum == total * (total - 1) / 2);
+    }
+
+    /* Typed channels select alongside C channels */
+    {
+        chan::Channel<Tracked, 1> typed;
+        channel_t* raw = channel_create(1);
+        select_t list[2] = {typed.select_recv(), {raw, RECV, nullptr}};
+        typed.emplace(7);
+        size_t index = 2;
+        mu_assert("test_cpp_channel: Select failed\n", channel_select(list, 2, &index) == SUCCESS && index == 0);
+        mu_assert("test_cpp_channel: Wrong message from select\n", typed.finish_recv(list[0]).value == 7);
+
+        select_t send_list[2] = {{raw, SEND, const_cast<char*>("full")}, typed.select_send()};
+        channel_send(raw, const_cast<char*>("fill"));
+        mu_assert("test_cpp_channel: Select send failed\n", channel_select(send_list, 2, &index) == SUCCESS && index == 1);
+        mu_assert("test_cpp_channel: Finishing the send failed\n", typed.finish_send(send_list[1], 8) == SUCCESS);
+        mu_assert("test_cpp_channel: Channel is not full after the selected send\n", typed.try_emplace(9) == CHANNEL_FULL);
+        std::optional<Tracked> sent = typed.receive();
+        mu_assert("test_cpp_channel: Wrong message after select send\n", sent && sent->value == 8);
+
+        channel_close(raw);
+        channel_destroy(raw);
+    }
+    mu_assert("test_cpp_channel: Messages leaked\n", Tracked::live == 0);
+    return NULL;
+}
+
+char* test_cpp_coroutines()
+{
+    print_test_details(__func__, "Testing C++ coroutine send, receive and select on single and multi-threaded executors");
+
+    /* Thousands of actors share the calling thread */
+    {
+        const size_t num_stages = 2000;
+        const int count = 50;
+        chan::SingleThreadExecutor executor(num_stages + 2);
+        long sum = run_pipeline(executor, num_stages, 1, count);
+        mu_assert("test_cpp_coroutines: Wrong sum through the single-threaded pipeline\n",
+                  sum == (long)count * (count + 1) / 2 + (long)count * (long)num_stages);
+        mu_assert("test_cpp_coroutines: Actors did not all finish\n", executor.outstanding() == 0);
+    }
+
+    /* The same actors on a pool of workers */
+    {
+        const size_t num_stages = 200;
+        const int count = 500;
+        chan::ThreadPoolExecutor executor(4, num_stages + 2);
+        long sum = run_pipeline(executor, num_stages, 2, count);
+        mu_assert("test_cpp_coroutines: Wrong sum through the multi-threaded pipeline\n",
+                  sum == (long)count * (count + 1) / 2 + (long)count * (long)num_stages);
+    }
+
+    /* An actor selects over channels fed by plain threads blocking in send */
+    {
+        chan::ThreadPoolExecutor executor(2, 2);
+        chan::Channel<int> first(1);
+        chan::Channel<int> second(4);
+        chan::Channel<int> idle(1);
+        int sums[2] = {0, 0};
+        bool closed = false;
+        executor.spawn(merge(first, second, 2000, sums));
+        executor.spawn(wait_for_close(idle, closed));
+        std::thread first_sender([&first] {
+            for (int i = 0; i < 1000; i++) {
+                first.send(1);
+            }
+        });
+        std::thread second_sender([&second] {
+            for (int i = 0; i < 1000; i++) {
+                second.send(2);
+            }
+        });
+        first_sender.join();
+        second_sender.join();
+        idle.close();
+        executor.wait();
+        mu_assert("test_cpp_coroutines: Select missed messages\n", sums[0] == 1000 && sums[1] == 2000);
+        mu_assert("test_cpp_coroutines: Close did not wake the waiting actor\n", closed);
+    }
+    return NULL;
+}
+
+char* test_cpp_select()
+{
+    print_test_details(__func__, "Testing the typed variadic C++ select");
+
+    /* The ready case runs its handler with the typed message */
+    {
+        chan::Channel<int, 1> numbers;
+        chan::Channel<std::string> words(2);
+        channel_t* raw = channel_create(1);
+        int number = 0;
+        std::string word;
+        void* raw_message = nullptr;
+        auto cases = [&] {
+            return chan::try_select(chan::on_recv(numbers, [&number](int value) { number = value; }),
+                                    chan::on_recv(words, [&word](std::string value) { word = std::move(value); }),
+                                    chan::on_recv(raw, [&raw_message](void* data) { raw_message = data; }));
+        };
+        mu_assert("test_cpp_select: Select on empty channels did not return CHANNEL_EMPTY\n", cases().first == CHANNEL_EMPTY);
+        words.send("hello");
+        auto [status, index] = chan::select(chan::on_recv(numbers, [&number](int value) { number = value; }),
+                                            chan::on_recv(words, [&word](std::string value) { word = std::move(value); }));
+        mu_assert("test_cpp_select: Wrong case selected\n", status == SUCCESS && index == 1 && word == "hello" && number == 0);
+        channel_send(raw, const_cast<char*>("raw"));
+        mu_assert("test_cpp_select: C channel case not selected\n", cases().second == 2 && raw_message != nullptr);
+        numbers.send(5);
+        words.send("first wins");
+        mu_assert("test_cpp_select: First ready case did not win\n", cases().second == 0 && number == 5 && word == "hello");
+
+        /* Send cases build the message only when chosen, and the same channel may appear twice */
+        bool sent = false;
+        std::string message = "moved";
+        auto sent_case = chan::select(chan::on_send(numbers, 7, [&sent] { sent = true; }), chan::on_send(numbers, 8));
+        mu_assert("test_cpp_select: Send case did not run\n", sent_case.first == SUCCESS && sent_case.second == 0 && sent);
+        mu_assert("test_cpp_select: Full channel was selected for send\n",
+                  chan::try_select(chan::on_send(numbers, 9), chan::on_send(words, std::move(message))).second == 1);
+        mu_assert("test_cpp_select: Wrong message sent\n", numbers.receive() == 7);
+        std::string received;
+        words.receive(received);
+        mu_assert("test_cpp_select: Messages out of order\n", received == "first wins" && words.receive() == "moved");
+
+        /* A closed channel fails the select without running a handler */
+        numbers.close();
+        number = 0;
+        auto closed = chan::select(chan::on_recv(numbers, [&number](int value) { number = value; }));
+        mu_assert("test_cpp_select: Closed channel did not return CLOSED_ERROR\n", closed.first == CLOSED_ERROR && number == 0);
+        channel_close(raw);
+        channel_destroy(raw);
+    }
+
+    /* Coroutines select over typed cases */
+    {
+        chan::ThreadPoolExecutor executor(2, 1);
+        chan::Channel<int> first(2);
+        chan::Channel<std::string> second(2);
+        long sum = 0;
+        executor.spawn(merge_cases(first, second, 2000, sum));
+        std::thread sender([&first] {
+            for (int i = 0; i < 1000; i++) {
+                first.send(1);
+            }
+        });
+        for (int i = 0; i < 1000; i++) {
+            second.send("2");
+        }
+        sender.join();
+        executor.wait();
+        mu_assert("test_cpp_select: Coroutine select missed messages\n", sum == 3000);
+    }
+    return NULL;
+}
+
+char* test_cpp_policy()
+{
+    print_test_details(__func__, "Testing the policy-based C++ channel with every lock and wait policy");
+
+    /* Every lock and wait policy pair moves messages correctly */
+    using Inline = chan::policy::InlineRing<4>;
+    mu_assert("test_cpp_policy: Condvar wait failed\n", (check_locks<Inline, chan::policy::CondvarWait>() == NULL));
+    mu_assert("test_cpp_policy: Futex wait failed\n", (check_locks<Inline, chan::policy::FutexWait>() == NULL));
+    mu_assert("test_cpp_policy: Spin wait failed\n", (check_locks<Inline, chan::policy::SpinWait>() == NULL));
+    mu_assert("test_cpp_policy: Heap ring failed\n", (check_locks<chan::policy::HeapRing, chan::policy::FutexWait>((size_t)1) == NULL));
+
+    /* Try operations report a full or empty channel, and messages left behind are destroyed */
+    {
+        chan::policy::Channel<Tracked, chan::policy::HeapRing, chan::policy::CondvarWait, chan::policy::McsLock> channel(2);
+        Tracked out(0);
+        mu_assert("test_cpp_policy: Empty channel did not return CHANNEL_EMPTY\n", channel.try_receive(out) == CHANNEL_EMPTY);
+        mu_assert("test_cpp_policy: Emplace failed\n", channel.emplace(1) == SUCCESS && channel.try_emplace(2) == SUCCESS);
+        mu_assert("test_cpp_policy: Full channel did not return CHANNEL_FULL\n", channel.try_emplace(3) == CHANNEL_FULL);
+        mu_assert("test_cpp_policy: Wrong message\n", channel.try_receive(out) == SUCCESS && out.value == 1);
+        channel.emplace(4);
+        mu_assert("test_cpp_policy: Messages were copied or lost\n", Tracked::live == 3);
+    }
+    mu_assert("test_cpp_policy: Messages left in the channel were not destroyed\n", Tracked::live == 0);
+    return NULL;
+}
+
+char* test_cpp_allocator()
+{
+    print_test_details(__func__, "Testing C++ channels allocating from memory resources");
+
+    /* A monotonic resource over a local buffer, with no upstream, serves every allocation of a channel */
+    {
+        alignas(std::max_align_t) unsigned char arena[8192];
+        std::pmr::monotonic_buffer_resource monotonic(arena, sizeof(arena), std::pmr::null_memory_resource());
+        CountingResource counting(&monotonic);
+        {
+            chan::Channel<int> numbers(8, &counting);
+            chan::Channel<Tracked, 2> tracked(&counting);
+            mu_assert("test_cpp_allocator: Channels did not allocate from the resource\n", counting.allocations > 0);
+            size_t created = counting.allocations;
+            for (int i = 1; i <= 8; i++) {
+                mu_assert("test_cpp_allocator: Send failed\n", numbers.send(i) == SUCCESS);
+            }
+            int value = 0;
+            mu_assert("test_cpp_allocator: Receive failed\n", numbers.receive(value) == SUCCESS && value == 1);
+            mu_assert("test_cpp_allocator: Emplace failed\n", tracked.emplace(3) == SUCCESS);
+            mu_assert("test_cpp_allocator: Send and receive allocated\n", counting.allocations == created);
+            auto [status, index] = chan::select(chan::on_recv(tracked, [&value](Tracked message) { value = message.value; }),
+                                                chan::on_recv(numbers, [](int) {}));
+            mu_assert("test_cpp_allocator: Select failed\n", status == SUCCESS && index == 0 && value == 3);
+        }
+        mu_assert("test_cpp_allocator: Memory was not returned to the resource\n", counting.live_bytes == 0);
+        mu_assert("test_cpp_allocator: Messages leaked\n", Tracked::live == 0);
+    }
+
+    /* Threads blocking in select share a synchronized pool resource */
+    {
+        std::pmr::synchronized_pool_resource pool;
+        CountingResource counting(&pool);
+        {
+            chan::Channel<size_t> requests(4, &counting);
+            chan::Channel<size_t> replies(4, &counting);
+            const size_t count = 2000;
+            std::thread server([&requests, &replies] {
+                size_t request = 0;
+                while (chan::select(chan::on_recv(requests, [&request](size_t value) { request = value; })).first == SUCCESS) {
+                    if (replies.send(request * 2) != SUCCESS) {
+                        break;
+                    }
+                }
+            });
+            size_t sum = 0;
+            for (size_t i = 1; i <= count; i++) {
+                requests.send(i);
+                chan::select(chan::on_recv(replies, [&sum](size_t value) { sum += value; }));
+            }
+            requests.close();
+            server.join();
+            mu_assert("test_cpp_allocator: Wrong replies\n", sum == count * (count + 1));
+        }
+        mu_assert("test_cpp_allocator: Memory was not returned to the resource\n", counting.live_bytes == 0);
+    }
+
+    /* A resource that runs out at any point of construction gets every block back */
+    {
+        alignas(std::max_align_t) unsigned char arena[2048];
+        size_t failures = 0;
+        for (size_t size = 64; size <= sizeof(arena); size += 64) {
+            std::pmr::monotonic_buffer_resource monotonic(arena, size, std::pmr::null_memory_resource());
+            CountingResource counting(&monotonic);
+            try {
+                chan::Channel<int> numbers(16, &counting);
+            } catch (const std::bad_alloc&) {
+                failures++;
+            }
+            mu_assert("test_cpp_allocator: Failed construction leaked memory\n", counting.live_bytes == 0);
+        }
+        mu_assert("test_cpp_allocator: Exhausted resource did not throw\n", failures > 0 && failures < sizeof(arena) / 64);
+    }
+
+    /* Blocking on a channel whose resource is exactly used up by construction fails with GEN_ERROR */
+    {
+        alignas(std::max_align_t) unsigned char arena[2048];
+        size_t size = 8;
+        for (; size <= sizeof(arena); size += 8) {
+            std::pmr::monotonic_buffer_resource monotonic(arena, size, std::pmr::null_memory_resource());
+            try {
+                chan::Channel<int> numbers(4, &monotonic);
+                break;
+            } catch (const std::bad_alloc&) {
+            }
+        }
+        mu_assert("test_cpp_allocator: Channel never fit in the arena\n", size <= sizeof(arena));
+        std::pmr::monotonic_buffer_resource monotonic(arena, size, std::pmr::null_memory_resource());
+        CountingResource counting(&monotonic);
+        {
+            chan::Channel<int> numbers(4, &counting);
+            auto [status, index] = chan::select(chan::on_recv(numbers, [](int) {}));
+            mu_assert("test_cpp_allocator: Blocking select without memory did not return GEN_ERROR\n", status == GEN_ERROR && index == 0);
+
+            chan::SingleThreadExecutor executor(2);
+            bool received = true;
+            enum channel_status select_status = SUCCESS;
+            executor.spawn(receive_once(numbers, received));
+            executor.spawn(select_once(numbers, select_status));
+            executor.run();
+            mu_assert("test_cpp_allocator: Receive without memory returned a message\n", !received);
+            mu_assert("test_cpp_allocator: Coroutine select without memory did not return GEN_ERROR\n", select_status == GEN_ERROR);
+
+            mu_assert("test_cpp_allocator: Send failed\n", numbers.send(5) == SUCCESS);
+            mu_assert("test_cpp_allocator: Receive failed\n", numbers.receive() == std::optional<int>(5));
+        }
+        mu_assert("test_cpp_allocator: Memory was not returned to the resource\n", counting.live_bytes == 0);
+    }
+    return NULL;
+}
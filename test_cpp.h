@@ -0,0 +1,24 @@
+#ifndef TEST_CPP_H
+#define TEST_CPP_H
+
+// Tests of the C++ channel front-end, implemented in test_cpp.cpp and run from the test table in test.c
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char* test_cpp_channel();
+
+char* test_cpp_coroutines();
+
+char* test_cpp_select();
+
+char* test_cpp_policy();
+
+char* test_cpp_allocator();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_CPP_H
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "topology.h"
+
+// Allocates a topology with room for the given number of nodes and edges; offsets[0] is set to 0
+// The caller fills in the rows
+topology_t* topology_create(size_t num_nodes, size_t num_edges)
+{
+    topology_t* topology = malloc(sizeof(topology_t));
+    assert(topology != NULL);
+    topology->num_nodes = num_nodes;
+    topology->num_edges = num_edges;
+    topology->offsets = malloc(sizeof(uint64_t) * (num_nodes + 1));
+    topology->targets = malloc(sizeof(uint32_t) * (num_edges > 0 ? num_edges : 1));
+    topology->weights = malloc(sizeof(distance_t) * (num_edges > 0 ? num_edges : 1));
+    assert(topology->offsets != NULL && topology->targets != NULL && topology->weights != NULL);
+    topology->offsets[0] = 0;
+    topology->mapping = NULL;
+    topology->mapping_size = 0;
+    return topology;
+}
+
+// Parses the next integer at or after *cursor, skipping whitespace, and advances *cursor past it
+// Negative values become inf_distance, as do values too large to be a distance
+static bool parse_distance(const char** cursor, const char* end, distance_t* distance)
+{
+    const char* p = *cursor;
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')) {
+        p++;
+    }
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return false;
+    }
+    uint64_t value = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        if (value <= inf_distance) {
+            value = value * 10 + (uint64_t)(*p - '0');
+        }
+    }
+    *distance = (negative || value > inf_distance) ? inf_distance : (distance_t)value;
+    *cursor = p;
+    return true;
+}
+
+static topology_t* load_text(const char* filename, const char* data, size_t size)
+{
+    const char* cursor = data;
+    const char* end = data + size;
+    distance_t num_nodes;
+    if (!parse_distance(&cursor, end, &num_nodes) || num_nodes == 0 || num_nodes == inf_distance) {
+        printf("Malformed topology file: %s\n", filename);
+        return NULL;
+    }
+    // grown by doubling as links are found
+    size_t capacity = num_nodes;
+    topology_t* topology = topology_create(num_nodes, capacity);
+    size_t num_edges = 0;
+    for (size_t src = 0; src < num_nodes; src++) {
+        for (size_t dst = 0; dst < num_nodes; dst++) {
+            distance_t distance;
+            if (!parse_distance(&cursor, end, &distance)) {
+                printf("Malformed topology file: %s\n", filename);
+                topology_destroy(topology);
+                return NULL;
+            }
+            if (src == dst || distance == inf_distance) {
+                continue;
+            }
+            if (num_edges == capacity) {
+                capacity *= 2;
+                topology->targets = realloc(topology->targets, sizeof(uint32_t) * capacity);
+                topology->weights = realloc(topology->weights, sizeof(distance_t) * capacity);
+                assert(topology->targets != NULL && topology->weights != NULL);
+            }
+            topology->targets[num_edges] = (uint32_t)dst;
+            topology->weights[num_edges] = distance;
+            num_edges++;
+        }
+        topology->offsets[src + 1] = num_edges;
+    }
+    topology->num_edges = num_edges;
+    return topology;
+}
+
+// Points the topology arrays into the mapped file after checking that its sizes and rows are consistent
+static topology_t* load_binary(const char* filename, void* data, size_t size)
+{
+    const topology_header_t* header = (const topology_header_t*)data;
+    uint64_t num_nodes = header->num_nodes;
+    uint64_t num_edges = header->num_edges;
+    if (num_nodes == 0 || num_nodes > UINT32_MAX || num_edges > SIZE_MAX / 16 ||
+        size != sizeof(topology_header_t) + sizeof(uint64_t) * (num_nodes + 1) + (sizeof(uint32_t) + sizeof(distance_t)) * num_edges) {
+        printf("Malformed topology file: %s\n", filename);
+        return NULL;
+    }
+    topology_t* topology = malloc(sizeof(topology_t));
+    assert(topology != NULL);
+    topology->num_nodes = num_nodes;
+    topology->num_edges = num_edges;
+    topology->offsets = (uint64_t*)((char*)data + sizeof(topology_header_t));
+    topology->targets = (uint32_t*)(topology->offsets + num_nodes + 1);
+    topology->weights = (distance_t*)(topology->targets + num_edges);
+    topology->mapping = data;
+    topology->mapping_size = size;
+    bool valid = topology->offsets[0] == 0 && topology->offsets[num_nodes] == num_edges;
+    for (size_t src = 0; valid && src < num_nodes; src++) {
+        valid = topology->offsets[src] <= topology->offsets[src + 1] && topology->offsets[src + 1] <= num_edges;
+        for (uint64_t edge = topology->offsets[src]; valid && edge < topology->offsets[src + 1]; edge++) {
+            uint32_t dst = topology->targets[edge];
+            valid = dst < num_nodes && dst != src && topology->weights[edge] < inf_distance &&
+                    (edge == topology->offsets[src] || topology->targets[edge - 1] < dst);
+        }
+    }
+    if (!valid) {
+        printf("Malformed topology file: %s\n", filename);
+        // the caller still owns the mapping
+        topology->mapping = NULL;
+        free(topology);
+        return NULL;
+    }
+    return topology;
+}
+
+// Loads a topology from a text or binary file, detected from the binary magic
+// The text format is the node count followed by the full num_nodes x num_nodes link matrix, negative meaning no link
+// Both formats are read through mmap; binary files are used in place without copying
+// Prints a message and returns NULL if the file cannot be read or is malformed
+topology_t* topology_load(const char* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Could not open topology file: %s\n", filename);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("Malformed topology file: %s\n", filename);
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Could not map topology file: %s\n", filename);
+        return NULL;
+    }
+    topology_t* topology;
+    if (size >= sizeof(topology_header_t) && memcmp(data, TOPOLOGY_MAGIC, sizeof(TOPOLOGY_MAGIC)) == 0) {
+        topology = load_binary(filename, data, size);
+        if (topology == NULL) {
+            munmap(data, size);
+        }
+    } else {
+        madvise(data, size, MADV_SEQUENTIAL);
+        topology = load_text(filename, (const char*)data, size);
+        munmap(data, size);
+    }
+    return topology;
+}
+
+// Writes the topology in the text matrix format; returns false if the file cannot be written
+bool topology_save_text(const topology_t* topology, const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "%zu\n", topology->num_nodes);
+    for (size_t src = 0; src < topology->num_nodes; src++) {
+        uint64_t edge = topology->offsets[src];
+        for (size_t dst = 0; dst < topology->num_nodes; dst++) {
+            long distance = -1;
+            if (dst == src) {
+                distance = 0;
+            } else if (edge < topology->offsets[src + 1] && topology->targets[edge] == dst) {
+                distance = topology->weights[edge++];
+            }
+            fprintf(file, dst == 0 ? "%2ld" : " %2ld", distance);
+        }
+        fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
+
+// Writes the topology in the binary CSR format; returns false if the file cannot be written
+bool topology_save_binary(const topology_t* topology, const char* filename)
+{
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    topology_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TOPOLOGY_MAGIC, sizeof(TOPOLOGY_MAGIC));
+    header.num_nodes = topology->num_nodes;
+    header.num_edges = topology->num_edges;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(topology->offsets, sizeof(uint64_t), topology->num_nodes + 1, file) == topology->num_nodes + 1 &&
+                   fwrite(topology->targets, sizeof(uint32_t), topology->num_edges, file) == topology->num_edges &&
+                   fwrite(topology->weights, sizeof(distance_t), topology->num_edges, file) == topology->num_edges;
+    return (fclose(file) == 0) && written;
+}
+
+// Returns the distance of the direct link from src to dst, 0 if they are equal and inf_distance if there is none
+distance_t topology_link_distance(const topology_t* topology, size_t src, size_t dst)
+{
+    if (src == dst) {
+        return 0;
+    }
+    // rows are sorted by target
+    uint64_t low = topology->offsets[src];
+    uint64_t high = topology->offsets[src + 1];
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        if (topology->targets[mid] < dst) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < topology->offsets[src + 1] && topology->targets[low] == dst) {
+        return topology->weights[low];
+    }
+    return inf_distance;
+}
+
+// Expands the topology into a dense num_nodes x num_nodes row-major link matrix
+void topology_to_matrix(const topology_t* topology, distance_t* matrix)
+{
+    size_t num_nodes = topology->num_nodes;
+    for (size_t src = 0; src < num_nodes; src++) {
+        distance_t* row = matrix + src * num_nodes;
+        for (size_t dst = 0; dst < num_nodes; dst++) {
+            row[dst] = inf_distance;
+        }
+        row[src] = 0;
+        for (uint64_t edge = topology->offsets[src]; edge < topology->offsets[src + 1]; edge++) {
+            row[topology->targets[edge]] = topology->weights[edge];
+        }
+    }
+}
+
+// Frees the topology and unmaps its file, if any
+void topology_destroy(topology_t* topology)
+{
+    if (topology->mapping != NULL) {
+        munmap(topology->mapping, topology->mapping_size);
+    } else {
+        free(topology->offsets);
+        free(topology->targets);
+        free(topology->weights);
+    }
+    free(topology);
+}
@@ -0,0 +1,58 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "distance.h"
+
+// Router topology as a compressed sparse row (CSR) adjacency list
+// The links of node src are targets[offsets[src]] to targets[offsets[src + 1] - 1], sorted by target,
+// with matching weights; self links are implicit with distance 0 and never stored
+typedef struct {
+    size_t num_nodes;
+    size_t num_edges;
+    // num_nodes + 1 entries; offsets[0] is 0 and offsets[num_nodes] is num_edges
+    uint64_t* offsets;
+    uint32_t* targets;
+    distance_t* weights;
+    // Mapped binary file the arrays point into, or NULL if they were allocated
+    void* mapping;
+    size_t mapping_size;
+} topology_t;
+
+// Binary topology file layout, all fields in native byte order:
+// topology_header_t, then uint64_t offsets[num_nodes + 1], uint32_t targets[num_edges], uint32_t weights[num_edges]
+#define TOPOLOGY_MAGIC "CHTOPO1"
+typedef struct {
+    char magic[8];
+    uint64_t num_nodes;
+    uint64_t num_edges;
+} topology_header_t;
+
+// Allocates a topology with room for the given number of nodes and edges; offsets[0] is set to 0
+// The caller fills in the rows
+topology_t* topology_create(size_t num_nodes, size_t num_edges);
+
+// Loads a topology from a text or binary file, detected from the binary magic
+// The text format is the node count followed by the full num_nodes x num_nodes link matrix, negative meaning no link
+// Both formats are read through mmap; binary files are used in place without copying
+// Prints a message and returns NULL if the file cannot be read or is malformed
+topology_t* topology_load(const char* filename);
+
+// Writes the topology in the text matrix format; returns false if the file cannot be written
+bool topology_save_text(const topology_t* topology, const char* filename);
+
+// Writes the topology in the binary CSR format; returns false if the file cannot be written
+bool topology_save_binary(const topology_t* topology, const char* filename);
+
+// Returns the distance of the direct link from src to dst, 0 if they are equal and inf_distance if there is none
+distance_t topology_link_distance(const topology_t* topology, size_t src, size_t dst);
+
+// Expands the topology into a dense num_nodes x num_nodes row-major link matrix
+void topology_to_matrix(const topology_t* topology, distance_t* matrix);
+
+// Frees the topology and unmaps its file, if any
+void topology_destroy(topology_t* topology);
+
+#endif // TOPOLOGY_H
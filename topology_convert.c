@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "topology.h"
+
+void usage(const char* prog) {
+    printf("Usage: %s [-f text|binary] input output\n", prog);
+    printf("  Converts a topology file; the input format is detected from its contents\n");
+    printf("  -f format   output format: text or binary (default binary)\n");
+}
+
+int main(int argc, char** argv) {
+    bool binary = true;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:h")) != -1) {
+        switch (opt) {
+            case 'f':
+                if (strcmp(optarg, "text") == 0) {
+                    binary = false;
+                } else if (strcmp(optarg, "binary") == 0) {
+                    binary = true;
+                } else {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    topology_t* topology = topology_load(argv[optind]);
+    if (topology == NULL) {
+        return 1;
+    }
+    bool saved = binary ? topology_save_binary(topology, argv[optind + 1]) : topology_save_text(topology, argv[optind + 1]);
+    if (!saved) {
+        printf("Could not write topology file: %s\n", argv[optind + 1]);
+    } else {
+        printf("%s: %zu nodes, %zu links\n", argv[optind + 1], topology->num_nodes, topology->num_edges);
+    }
+    topology_destroy(topology);
+    return saved ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "topology_gen.h"
+
+typedef struct {
+    uint32_t src;
+    uint32_t dst;
+    distance_t weight;
+} link_t;
+
+typedef struct {
+    link_t* links;
+    size_t count;
+    size_t capacity;
+} link_list_t;
+
+static const char* family_names[] = {"ring", "grid", "er", "ba", "hub"};
+
+// Returns the family with the given name (ring, grid, er, ba or hub), or -1 if there is none
+int topology_family_parse(const char* name)
+{
+    for (size_t i = 0; i < sizeof(family_names) / sizeof(family_names[0]); i++) {
+        if (strcmp(name, family_names[i]) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Returns the short name of the family, as accepted by topology_family_parse
+const char* topology_family_name(enum topology_family family)
+{
+    return family_names[family];
+}
+
+// Returns the next value of a xorshift64 state
+static uint64_t next_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Adds the undirected link between a and b as two directed links with the same weight
+static void add_link(link_list_t* list, size_t a, size_t b, distance_t max_weight, uint64_t* state)
+{
+    if (a == b) {
+        return;
+    }
+    if (list->count + 2 > list->capacity) {
+        list->capacity = list->capacity > 0 ? list->capacity * 2 : 64;
+        list->links = realloc(list->links, sizeof(link_t) * list->capacity);
+        assert(list->links != NULL);
+    }
+    distance_t weight = (distance_t)(next_random(state) % max_weight) + 1;
+    list->links[list->count++] = (link_t){(uint32_t)a, (uint32_t)b, weight};
+    list->links[list->count++] = (link_t){(uint32_t)b, (uint32_t)a, weight};
+}
+
+static int compare_links(const void* a, const void* b)
+{
+    const link_t* x = (const link_t*)a;
+    const link_t* y = (const link_t*)b;
+    if (x->src != y->src) {
+        return x->src < y->src ? -1 : 1;
+    }
+    if (x->dst != y->dst) {
+        return x->dst < y->dst ? -1 : 1;
+    }
+    if (x->weight != y->weight) {
+        return x->weight < y->weight ? -1 : 1;
+    }
+    return 0;
+}
+
+// Sorts the links by source and target and drops repeats, keeping the lightest
+// Both directions of a repeated link sort the same way, so the kept weights stay symmetric
+static void sort_links(link_list_t* list)
+{
+    if (list->count == 0) {
+        return;
+    }
+    qsort(list->links, list->count, sizeof(link_t), compare_links);
+    size_t kept = 1;
+    for (size_t i = 1; i < list->count; i++) {
+        if (list->links[i].src != list->links[kept - 1].src || list->links[i].dst != list->links[kept - 1].dst) {
+            list->links[kept++] = list->links[i];
+        }
+    }
+    list->count = kept;
+}
+
+static void generate_erdos_renyi(link_list_t* list, size_t num_nodes, size_t num_edges, distance_t max_weight, uint64_t* state)
+{
+    size_t max_edges = num_nodes * (num_nodes - 1) / 2;
+    if (num_edges > max_edges) {
+        num_edges = max_edges;
+    }
+    // draw the missing links in batches; repeats and self links are dropped, so a batch never overshoots
+    while (list->count / 2 < num_edges) {
+        size_t missing = num_edges - list->count / 2;
+        for (size_t i = 0; i < missing; i++) {
+            add_link(list, next_random(state) % num_nodes, next_random(state) % num_nodes, max_weight, state);
+        }
+        sort_links(list);
+    }
+}
+
+static void generate_scale_free(link_list_t* list, size_t num_nodes, size_t num_edges, distance_t max_weight, uint64_t* state)
+{
+    size_t per_node = num_edges / num_nodes > 0 ? num_edges / num_nodes : 1;
+    size_t seed_nodes = per_node + 1 < num_nodes ? per_node + 1 : num_nodes;
+    // every link contributes both endpoints, so a uniform pick from here is a pick proportional to degree
+    size_t* endpoints = malloc(sizeof(size_t) * 2 * (seed_nodes * seed_nodes + num_nodes * per_node));
+    size_t* chosen = malloc(sizeof(size_t) * per_node);
+    assert(endpoints != NULL && chosen != NULL);
+    size_t num_endpoints = 0;
+    for (size_t a = 0; a < seed_nodes; a++) {
+        for (size_t b = a + 1; b < seed_nodes; b++) {
+            add_link(list, a, b, max_weight, state);
+            endpoints[num_endpoints++] = a;
+            endpoints[num_endpoints++] = b;
+        }
+    }
+    for (size_t node = seed_nodes; node < num_nodes; node++) {
+        size_t num_chosen = 0;
+        while (num_chosen < per_node) {
+            size_t target = endpoints[next_random(state) % num_endpoints];
+            bool repeated = false;
+            for (size_t i = 0; i < num_chosen; i++) {
+                repeated = repeated || chosen[i] == target;
+            }
+            if (!repeated) {
+                chosen[num_chosen++] = target;
+            }
+        }
+        for (size_t i = 0; i < num_chosen; i++) {
+            add_link(list, node, chosen[i], max_weight, state);
+            endpoints[num_endpoints++] = node;
+            endpoints[num_endpoints++] = chosen[i];
+        }
+    }
+    free(endpoints);
+    free(chosen);
+}
+
+// Generates an undirected topology with the given number of nodes
+// num_edges is the target number of undirected links for the Erdős–Rényi and scale-free families
+// and is ignored by the others, whose link count follows from their shape
+// Link weights are drawn uniformly from 1 to max_weight; the same seed always produces the same topology
+topology_t* topology_generate(enum topology_family family, size_t num_nodes, size_t num_edges, distance_t max_weight, uint64_t seed)
+{
+    assert(num_nodes > 0 && num_nodes <= UINT32_MAX);
+    assert(max_weight > 0 && max_weight < inf_distance);
+    // xorshift must not start from zero
+    uint64_t state = seed * 0x9e3779b97f4a7c15ull + 1;
+    link_list_t list = {NULL, 0, 0};
+    switch (family) {
+        case TOPOLOGY_RING:
+            for (size_t node = 0; node < num_nodes; node++) {
+                add_link(&list, node, (node + 1) % num_nodes, max_weight, &state);
+            }
+            break;
+        case TOPOLOGY_GRID: {
+            size_t side = 1;
+            while (side * side < num_nodes) {
+                side++;
+            }
+            for (size_t node = 0; node < num_nodes; node++) {
+                if ((node + 1) % side != 0 && node + 1 < num_nodes) {
+                    add_link(&list, node, node + 1, max_weight, &state);
+                }
+                if (node + side < num_nodes) {
+                    add_link(&list, node, node + side, max_weight, &state);
+                }
+            }
+            break;
+        }
+        case TOPOLOGY_ERDOS_RENYI:
+            generate_erdos_renyi(&list, num_nodes, num_edges, max_weight, &state);
+            break;
+        case TOPOLOGY_SCALE_FREE:
+            generate_scale_free(&list, num_nodes, num_edges, max_weight, &state);
+            break;
+        case TOPOLOGY_HUB:
+            for (size_t node = 1; node < num_nodes; node++) {
+                add_link(&list, 0, node, max_weight, &state);
+            }
+            break;
+    }
+    sort_links(&list);
+
+    topology_t* topology = topology_create(num_nodes, list.count);
+    size_t link = 0;
+    for (size_t src = 0; src < num_nodes; src++) {
+        for (; link < list.count && list.links[link].src == src; link++) {
+            topology->targets[link] = list.links[link].dst;
+            topology->weights[link] = list.links[link].weight;
+        }
+        topology->offsets[src + 1] = link;
+    }
+    free(list.links);
+    return topology;
+}
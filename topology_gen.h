@@ -0,0 +1,35 @@
+#ifndef TOPOLOGY_GEN_H
+#define TOPOLOGY_GEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "topology.h"
+
+// Graph families produced by topology_generate
+enum topology_family {
+    // Each node linked to its two neighbors on a cycle
+    TOPOLOGY_RING,
+    // Nodes laid out row by row on a square grid, linked to their horizontal and vertical neighbors
+    TOPOLOGY_GRID,
+    // Erdős–Rényi G(n, m): num_edges distinct links chosen uniformly at random
+    TOPOLOGY_ERDOS_RENYI,
+    // Barabási–Albert preferential attachment: each new node links to num_edges / num_nodes existing nodes
+    // chosen in proportion to their degree, giving a scale-free degree distribution
+    TOPOLOGY_SCALE_FREE,
+    // Node 0 linked to every other node
+    TOPOLOGY_HUB,
+};
+
+// Returns the family with the given name (ring, grid, er, ba or hub), or -1 if there is none
+int topology_family_parse(const char* name);
+
+// Returns the short name of the family, as accepted by topology_family_parse
+const char* topology_family_name(enum topology_family family);
+
+// Generates an undirected topology with the given number of nodes
+// num_edges is the target number of undirected links for the Erdős–Rényi and scale-free families
+// and is ignored by the others, whose link count follows from their shape
+// Link weights are drawn uniformly from 1 to max_weight; the same seed always produces the same topology
+topology_t* topology_generate(enum topology_family family, size_t num_nodes, size_t num_edges, distance_t max_weight, uint64_t seed);
+
+#endif // TOPOLOGY_GEN_H
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "topology_gen.h"
+
+void usage(const char* prog) {
+    printf("Usage: %s -t family -n nodes [-m links] [-w weight] [-s seed] [-f text|binary] output\n", prog);
+    printf("  -t family   ring, grid, er (Erdos-Renyi), ba (Barabasi-Albert scale-free) or hub (hub-and-spoke)\n");
+    printf("  -n nodes    number of nodes\n");
+    printf("  -m links    target number of undirected links for er and ba (default 4 per node)\n");
+    printf("  -w weight   largest link weight; weights are uniform from 1 (default 1)\n");
+    printf("  -s seed     random seed (default 1)\n");
+    printf("  -f format   output format: text or binary (default binary)\n");
+}
+
+int main(int argc, char** argv) {
+    int family = -1;
+    size_t num_nodes = 0;
+    size_t num_edges = 0;
+    unsigned long max_weight = 1;
+    uint64_t seed = 1;
+    bool binary = true;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:n:m:w:s:f:h")) != -1) {
+        switch (opt) {
+            case 't':
+                family = topology_family_parse(optarg);
+                break;
+            case 'n':
+                num_nodes = strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                num_edges = strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                max_weight = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'f':
+                binary = strcmp(optarg, "text") != 0;
+                if (binary && strcmp(optarg, "binary") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (family < 0 || num_nodes == 0 || num_nodes > UINT32_MAX || max_weight == 0 || max_weight >= inf_distance || argc - optind != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (num_edges == 0) {
+        num_edges = 4 * num_nodes;
+    }
+    topology_t* topology = topology_generate((enum topology_family)family, num_nodes, num_edges, (distance_t)max_weight, seed);
+    bool saved = binary ? topology_save_binary(topology, argv[optind]) : topology_save_text(topology, argv[optind]);
+    if (!saved) {
+        printf("Could not write topology file: %s\n", argv[optind]);
+    } else {
+        // every undirected link is stored in both directions
+        printf("%s: %zu nodes, %zu links\n", argv[optind], topology->num_nodes, topology->num_edges / 2);
+    }
+    topology_destroy(topology);
+    return saved ? 0 : 1;
+}